@@ -1,332 +1,286 @@
 #include "crc.h"
 #include <stdbool.h>
 #include <string.h>
+#include <pthread.h>
+#ifdef CRC_GEN_TABLES
+#include <stdio.h>
+#endif
+
+/* x86-64 下按 CPU 特性在运行时选择 SSE4.2 / PCLMULQDQ 实现，其余平台只使用查表法
+   生成查表（CRC_GEN_TABLES）时只需要可移植的 C 代码 */
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__) && !defined(CRC_GEN_TABLES)
+#define CRC_HAVE_X86_64 1
+#define CRC_TARGET(features) __attribute__((target(features)))
+#include <immintrin.h>
+#endif
+
+/* 专用内核中循环次数为编译期常量，要求编译器完全展开（-O2 默认不展开） */
+#if defined(__GNUC__) || defined(__clang__)
+#define CRC_UNROLL _Pragma("GCC unroll 16")
+#else
+#define CRC_UNROLL
+#endif
 
 /* ==================== 预定义多项式 ==================== */
 #define CRC16_POLY  UINT16_C(0x1021)        /* CRC-16/CCITT-FALSE */
-#define CRC32_POLY  UINT32_C(0xedb88320)    /* CRC-32 (Ethernet, ZIP) */
-#define CRC64_POLY  UINT64_C(0xad93d23594c935a9) /* CRC-64 (Redis) */
+#define CRC32_POLY  UINT32_C(0xedb88320)    /* CRC-32 (Ethernet, ZIP)，反射形式 */
+#define CRC32C_POLY UINT32_C(0x82f63b78)    /* CRC-32C (Castagnoli)，反射形式 */
+#define CRC64_POLY  UINT64_C(0xad93d23594c935a9) /* CRC-64/Jones (Redis)，正常形式 */
 
-/* ==================== 查表法加速表 ==================== */
-static uint64_t crc64_table[8][256];        /* Slice-by-8 for CRC64 */
-static uint32_t crc32_table[4][256];        /* Slice-by-4 for CRC32 */
-static uint16_t crc16_table[2][256];        /* Slice-by-2 for CRC16 */
-
-/* ==================== CRC参数结构体 ==================== */
-typedef struct {
-    uint8_t  width;                         /* 位宽：16, 32, 64 */
-    uint64_t poly;                          /* 多项式 */
-    uint64_t init;                          /* 初始值 */
-    bool     ref_in;                        /* 输入反射 */
-    bool     ref_out;                       /* 输出反射 */
-    uint64_t xor_out;                       /* 最终异或值 */
-    uint8_t  slice_level;                   /* Slice-by-N级别 */
-} CRCParams;
+/* 正常形式多项式（不含最高次项），用于计算 PCLMULQDQ 折叠常数 */
+#define CRC32_POLY_NORMAL   UINT32_C(0x04c11db7)
+#define CRC32C_POLY_NORMAL  UINT32_C(0x1edc6f41)
 
 /* ==================== 工具函数 ==================== */
 
 /**
- * @brief 反射单个字节(8位)
- * @param byte 要反射的字节
- * @return 反射后的字节
+ * @brief 按小端序读取n字节（n为编译期常量时编译器合并为一次加载，与主机字节序无关）
  */
-static inline uint8_t reflect_byte(uint8_t byte) {
-    byte = (byte & 0xF0) >> 4 | (byte & 0x0F) << 4;
-    byte = (byte & 0xCC) >> 2 | (byte & 0x33) << 2;
-    byte = (byte & 0xAA) >> 1 | (byte & 0x55) << 1;
-    return byte;
+static inline uint64_t crc_load_le(const uint8_t *p, unsigned n) {
+    uint64_t v = 0;
+    CRC_UNROLL
+    for (unsigned i = 0; i < n; i++)
+        v |= (uint64_t)p[i] << (8 * i);
+    return v;
 }
 
 /**
- * @brief 反射数据(低width位)
- * @param data  要反射的数据
- * @param width 要反射的位数
- * @return 反射后的数据
+ * @brief 按大端序读取n字节
  */
-static inline uint64_t crc_reflect(uint64_t data, uint8_t width) {
-    uint64_t ret = 0;
-    for (uint8_t i = 0; i < width; i++) {
-        ret = (ret << 1) | (data & 0x01);
-        data >>= 1;
-    }
-    return ret;
+static inline uint64_t crc_load_be(const uint8_t *p, unsigned n) {
+    uint64_t v = 0;
+    CRC_UNROLL
+    for (unsigned i = 0; i < n; i++)
+        v = (v << 8) | p[i];
+    return v;
 }
 
-/**
- * @brief 检测系统是否为小端序
- * @return true-小端序, false-大端序
- */
-static inline bool is_little_endian() {
-    static const uint16_t test = 0x0102;
-    return *(const uint8_t*)&test == 0x02;
-}
+/* ==================== 查表数据 ==================== */
 
-/**
- * @brief 64位字节反转
- * @param a 要反转的64位数据
- * @return 反转后的64位数据
- */
-static inline uint64_t rev8(uint64_t a) {
-#if defined(__GNUC__) || defined(__clang__)
-    return __builtin_bswap64(a);
+#ifdef CRC_HAVE_X86_64
+/* 反射域折叠常数：lo 乘 128 位块的低 64 位（多项式高次部分），hi 乘高 64 位 */
+typedef struct {
+    uint64_t k512_lo, k512_hi;              /* 跨 4 个 128 位块折叠 */
+    uint64_t k128_lo, k128_hi;              /* 跨 1 个 128 位块折叠 */
+} CRCFoldConsts;
+#endif
+
+#ifdef CRC_GEN_TABLES
+/* 生成模式：表由文件末尾的生成器在运行时填充后输出 */
+static uint16_t crc16_table[8][256];
+static uint32_t crc32_table[16][256];
+static uint32_t crc32c_table[16][256];
+static uint64_t crc64_table[8][256];
 #else
-    a = ((a & 0x00000000FFFFFFFF) << 32) | ((a & 0xFFFFFFFF00000000) >> 32);
-    a = ((a & 0x0000FFFF0000FFFF) << 16) | ((a & 0xFFFF0000FFFF0000) >> 16);
-    a = ((a & 0x00FF00FF00FF00FF) << 8)  | ((a & 0xFF00FF00FF00FF00) >> 8);
-    return a;
+/* 编译期常量表（含折叠常数），由本文件的生成模式输出，无需运行时初始化 */
+#include "crc_table.h"
 #endif
-}
 
-/**
- * @brief 根据slice级别反转数据
- * @param chunk 要反转的数据块
- * @param slice 切片级别(2,4,8)
- * @return 反转后的数据
+/* ==================== 专用查表内核 ==================== */
+
+/*
+ * 每种配置展开出独立的内核，位宽、反射方向与切片数都是编译期常量，
+ * 内层循环没有按 width/ref_in 的分支，也不需要按主机字节序翻转数据：
+ *   static type name##_update(type crc, const uint8_t *p, uint64_t len);   不做初值/结果异或
+ * 使用 name##_table[slices][256]，table[k][i] 为字节 i 后接 k 个零字节的CRC
+ * 位宽等于 type 的位数，slices 不小于 sizeof(type)
  */
-static inline uint64_t rev_slice(uint64_t chunk, uint8_t slice) {
-    switch (slice) {
-        case 8: return rev8(chunk);
-        case 4: return (uint64_t)__builtin_bswap32((uint32_t)chunk);
-        case 2: return (uint64_t)__builtin_bswap16((uint16_t)chunk);
-        default: return chunk;
-    }
-}
 
-/* ==================== 查表法核心 ==================== */
+/* 反射CRC（低位先行） */
+#define CRC_DEFINE_REFLECTED(name, type, slices)                                      \
+    static type name##_update(type crc, const uint8_t *p, uint64_t len) {             \
+        while (len >= (slices)) {                                                     \
+            type x = (type)(crc ^ crc_load_le(p, sizeof(type)));                      \
+            type r = 0;                                                               \
+            CRC_UNROLL                                                                \
+            for (unsigned i = 0; i < sizeof(type); i++)                               \
+                r ^= name##_table[(slices) - 1 - i][(x >> (8 * i)) & 0xFF];           \
+            CRC_UNROLL                                                                \
+            for (unsigned i = sizeof(type); i < (slices); i++)                        \
+                r ^= name##_table[(slices) - 1 - i][p[i]];                            \
+            crc = r;                                                                  \
+            p += (slices);                                                            \
+            len -= (slices);                                                          \
+        }                                                                             \
+        while (len--)                                                                 \
+            crc = (type)((crc >> 8) ^ name##_table[0][(crc ^ *p++) & 0xFF]);          \
+        return crc;                                                                   \
+    }
 
-/**
- * @brief 初始化单层CRC表
- * @param table  表指针
- * @param params CRC参数
- */
-static void crc_init_single_table(void *table, const CRCParams *params) {
-    const uint64_t mask = (params->width == 64) ? UINT64_MAX : ((1ULL << params->width) - 1);
-    
-    for (int i = 0; i < 256; i++) {
-        uint8_t byte = (uint8_t)i;
-        if (params->ref_in) byte = reflect_byte(byte);
-        
-        uint64_t crc = params->ref_in ? byte : ((uint64_t)byte << (params->width - 8));
-        
-        for (int j = 0; j < 8; j++) {
-            if (params->ref_in) {
-                crc = (crc >> 1) ^ ((crc & 1) ? params->poly : 0);
-            } else {
-                crc = (crc << 1) ^ ((crc >> (params->width - 1)) ? params->poly : 0);
-            }
-        }
-        
-        /* 根据宽度存储到正确的表中 */
-        switch (params->width) {
-            case 16: ((uint16_t*)table)[i] = (uint16_t)(crc & mask); break;
-            case 32: ((uint32_t*)table)[i] = (uint32_t)(crc & mask); break;
-            case 64: ((uint64_t*)table)[i] = crc & mask; break;
-        }
+/* 非反射CRC（高位先行） */
+#define CRC_DEFINE_NORMAL(name, type, slices)                                         \
+    static type name##_update(type crc, const uint8_t *p, uint64_t len) {             \
+        const unsigned top = 8 * sizeof(type) - 8;                                    \
+        while (len >= (slices)) {                                                     \
+            type x = (type)(crc ^ crc_load_be(p, sizeof(type)));                      \
+            type r = 0;                                                               \
+            CRC_UNROLL                                                                \
+            for (unsigned i = 0; i < sizeof(type); i++)                               \
+                r ^= name##_table[(slices) - 1 - i][(x >> (top - 8 * i)) & 0xFF];     \
+            CRC_UNROLL                                                                \
+            for (unsigned i = sizeof(type); i < (slices); i++)                        \
+                r ^= name##_table[(slices) - 1 - i][p[i]];                            \
+            crc = r;                                                                  \
+            p += (slices);                                                            \
+            len -= (slices);                                                          \
+        }                                                                             \
+        while (len--)                                                                 \
+            crc = (type)((type)(crc << 8) ^ name##_table[0][((crc >> top) ^ *p++) & 0xFF]); \
+        return crc;                                                                   \
     }
+
+CRC_DEFINE_NORMAL(crc16, uint16_t, 8)           /* CRC-16/CCITT，Slice-by-8 */
+CRC_DEFINE_REFLECTED(crc32, uint32_t, 16)       /* CRC-32，Slice-by-16 */
+CRC_DEFINE_REFLECTED(crc32c, uint32_t, 16)      /* CRC-32C，Slice-by-16 */
+CRC_DEFINE_REFLECTED(crc64, uint64_t, 8)        /* CRC-64/Jones，Slice-by-8 */
+
+/* ==================== 硬件加速（x86-64） ==================== */
+
+#ifdef CRC_HAVE_X86_64
+
+/* 长度达到该值才使用 PCLMULQDQ 折叠，短数据查表更快 */
+#define CRC_FOLD_MIN_LEN 256
+
+CRC_TARGET("pclmul")
+static inline __m128i crc_fold_block(__m128i x, __m128i k, __m128i next) {
+    return _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x, k, 0x00),
+                                       _mm_clmulepi64_si128(x, k, 0x11)), next);
 }
 
 /**
- * @brief 初始化多层CRC表(Slice-by-N)
- * @param table  表指针
- * @param params CRC参数
+ * @brief PCLMULQDQ 折叠：把 len（>= 64）字节折叠为同余的 16 字节
+ *
+ * 反射CRC中寄存器初值等价于异或到数据开头，因此 crc 直接并入首块；
+ * 折叠结果写入 out，之后以寄存器 0 对 out 与剩余数据查表即可得到结果
+ * @return 未折叠的剩余数据起点，剩余长度写回 len
  */
-static void crc_init_multi_table(void *table, const CRCParams *params) {
-    /* 初始化基础表(第0层) */
-    crc_init_single_table(table, params);
-    
-    const uint64_t mask = (params->width == 64) ? UINT64_MAX : ((1ULL << params->width) - 1);
-    
-    /* 生成多层表 */
-    for (int layer = 1; layer < params->slice_level; layer++) {
-        for (int i = 0; i < 256; i++) {
-            uint64_t value;
-            
-            /* 从正确的表中读取值 */
-            switch (params->width) {
-                case 16: value = ((uint16_t(*)[256])table)[layer-1][i]; break;
-                case 32: value = ((uint32_t(*)[256])table)[layer-1][i]; break;
-                case 64: value = ((uint64_t(*)[256])table)[layer-1][i]; break;
-            }
-            
-            uint8_t index;
-            if (params->ref_in) {
-                index = value & 0xFF;
-            } else {
-                index = (value >> (params->width - 8)) & 0xFF;
-            }
-            
-            uint64_t new_value;
-            switch (params->width) {
-                case 16: new_value = ((uint16_t(*)[256])table)[0][index]; break;
-                case 32: new_value = ((uint32_t(*)[256])table)[0][index]; break;
-                case 64: new_value = ((uint64_t(*)[256])table)[0][index]; break;
-            }
-            
-            if (params->ref_in) {
-                new_value ^= (value >> 8);
-            } else {
-                new_value ^= (value << 8);
-            }
-            
-            /* 存储到正确的表中 */
-            switch (params->width) {
-                case 16: ((uint16_t(*)[256])table)[layer][i] = (uint16_t)(new_value & mask); break;
-                case 32: ((uint32_t(*)[256])table)[layer][i] = (uint32_t)(new_value & mask); break;
-                case 64: ((uint64_t(*)[256])table)[layer][i] = new_value & mask; break;
-            }
-        }
+CRC_TARGET("pclmul")
+static const uint8_t *crc_fold_pclmul(const CRCFoldConsts *k, uint64_t crc,
+                                      const uint8_t *p, uint64_t *len, uint8_t out[16]) {
+    const __m128i k512 = _mm_set_epi64x((long long)k->k512_hi, (long long)k->k512_lo);
+    const __m128i k128 = _mm_set_epi64x((long long)k->k128_hi, (long long)k->k128_lo);
+    uint64_t n = *len;
+
+    __m128i x0 = _mm_xor_si128(_mm_loadu_si128((const __m128i *)p), _mm_cvtsi64_si128((long long)crc));
+    __m128i x1 = _mm_loadu_si128((const __m128i *)(p + 16));
+    __m128i x2 = _mm_loadu_si128((const __m128i *)(p + 32));
+    __m128i x3 = _mm_loadu_si128((const __m128i *)(p + 48));
+    p += 64;
+    n -= 64;
+
+    while (n >= 64) {
+        x0 = crc_fold_block(x0, k512, _mm_loadu_si128((const __m128i *)p));
+        x1 = crc_fold_block(x1, k512, _mm_loadu_si128((const __m128i *)(p + 16)));
+        x2 = crc_fold_block(x2, k512, _mm_loadu_si128((const __m128i *)(p + 32)));
+        x3 = crc_fold_block(x3, k512, _mm_loadu_si128((const __m128i *)(p + 48)));
+        p += 64;
+        n -= 64;
     }
+
+    x0 = crc_fold_block(x0, k128, x1);
+    x0 = crc_fold_block(x0, k128, x2);
+    x0 = crc_fold_block(x0, k128, x3);
+    while (n >= 16) {
+        x0 = crc_fold_block(x0, k128, _mm_loadu_si128((const __m128i *)p));
+        p += 16;
+        n -= 16;
+    }
+
+    _mm_storeu_si128((__m128i *)out, x0);
+    *len = n;
+    return p;
+}
+
+CRC_TARGET("pclmul")
+static uint32_t crc32_pclmul(uint32_t crc, const uint8_t *p, uint64_t len) {
+    uint8_t folded[16];
+    if (len < CRC_FOLD_MIN_LEN)
+        return crc32_update(crc, p, len);
+    p = crc_fold_pclmul(&crc32_fold, crc, p, &len, folded);
+    return crc32_update(crc32_update(0, folded, 16), p, len);
 }
 
-/* ==================== 快速计算函数 ==================== */
+CRC_TARGET("pclmul")
+static uint64_t crc64_pclmul(uint64_t crc, const uint8_t *p, uint64_t len) {
+    uint8_t folded[16];
+    if (len < CRC_FOLD_MIN_LEN)
+        return crc64_update(crc, p, len);
+    p = crc_fold_pclmul(&crc64_fold, crc, p, &len, folded);
+    return crc64_update(crc64_update(0, folded, 16), p, len);
+}
 
 /**
- * @brief 通用CRC计算函数
- * @param data   输入数据指针
- * @param len    数据长度
- * @param table  CRC表指针
- * @param params CRC参数
- * @return 计算得到的CRC值
+ * @brief SSE4.2 crc32 指令计算 CRC-32C（指令固定为 Castagnoli 多项式）
  */
-static uint64_t crc_compute(const void *data, uint64_t len, const void *table, 
-                           const CRCParams *params) {
-    const uint8_t *ptr = (const uint8_t *)data;
-    uint64_t crc = params->init;
-    const uint64_t mask = (params->width == 64) ? UINT64_MAX : ((1ULL << params->width) - 1);
-    const uint8_t slice = params->slice_level;
-    
-    /* 处理未对齐的头部字节 */
-    while (len && ((uintptr_t)ptr % slice)) {
-        uint8_t byte = *ptr++;
+CRC_TARGET("sse4.2")
+static uint32_t crc32c_sse42(uint32_t crc, const uint8_t *p, uint64_t len) {
+    uint64_t c = crc;
+    while (len && ((uintptr_t)p & 7)) {
+        c = _mm_crc32_u8((uint32_t)c, *p++);
         len--;
-        
-        if (params->ref_in) {
-            byte = reflect_byte(byte);
-            uint8_t index = (crc ^ byte) & 0xFF;
-            switch (params->width) {
-                case 16: crc = (crc >> 8) ^ ((uint16_t(*)[256])table)[0][index]; break;
-                case 32: crc = (crc >> 8) ^ ((uint32_t(*)[256])table)[0][index]; break;
-                case 64: crc = (crc >> 8) ^ ((uint64_t(*)[256])table)[0][index]; break;
-            }
-        } else {
-            uint8_t index = ((crc >> (params->width - 8)) ^ byte) & 0xFF;
-            switch (params->width) {
-                case 16: crc = (crc << 8) ^ ((uint16_t(*)[256])table)[0][index]; break;
-                case 32: crc = (crc << 8) ^ ((uint32_t(*)[256])table)[0][index]; break;
-                case 64: crc = (crc << 8) ^ ((uint64_t(*)[256])table)[0][index]; break;
-            }
-        }
-        crc &= mask;
     }
-    
-    /* Slice-by-N处理对齐块 */
-    while (len >= slice) {
-        uint64_t chunk;
-        memcpy(&chunk, ptr, slice);
-        ptr += slice;
-        len -= slice;
-        
-        if (is_little_endian()) {
-            chunk = rev_slice(chunk, slice);
-        }
-        
-        crc ^= chunk;
-        
-        for (int i = 0; i < slice; i++) {
-            uint8_t index;
-            if (params->ref_in) {
-                index = (crc >> (i * 8)) & 0xFF;
-            } else {
-                index = (crc >> (params->width - 8 - i * 8)) & 0xFF;
-            }
-            
-            switch (params->width) {
-                case 16: 
-                    crc = ((uint16_t(*)[256])table)[i][index] ^ (params->ref_in ? (crc >> 8) : (crc << 8));
-                    break;
-                case 32:
-                    crc = ((uint32_t(*)[256])table)[i][index] ^ (params->ref_in ? (crc >> 8) : (crc << 8));
-                    break;
-                case 64:
-                    crc = ((uint64_t(*)[256])table)[i][index] ^ (params->ref_in ? (crc >> 8) : (crc << 8));
-                    break;
-            }
-            crc &= mask;
-        }
+    while (len >= 8) {
+        uint64_t v;
+        memcpy(&v, p, 8);
+        c = _mm_crc32_u64(c, v);
+        p += 8;
+        len -= 8;
     }
-    
-    /* 处理剩余字节 */
-    while (len--) {
-        uint8_t byte = *ptr++;
-        
-        if (params->ref_in) {
-            byte = reflect_byte(byte);
-            uint8_t index = (crc ^ byte) & 0xFF;
-            switch (params->width) {
-                case 16: crc = (crc >> 8) ^ ((uint16_t(*)[256])table)[0][index]; break;
-                case 32: crc = (crc >> 8) ^ ((uint32_t(*)[256])table)[0][index]; break;
-                case 64: crc = (crc >> 8) ^ ((uint64_t(*)[256])table)[0][index]; break;
-            }
-        } else {
-            uint8_t index = ((crc >> (params->width - 8)) ^ byte) & 0xFF;
-            switch (params->width) {
-                case 16: crc = (crc << 8) ^ ((uint16_t(*)[256])table)[0][index]; break;
-                case 32: crc = (crc << 8) ^ ((uint32_t(*)[256])table)[0][index]; break;
-                case 64: crc = (crc << 8) ^ ((uint64_t(*)[256])table)[0][index]; break;
-            }
-        }
-        crc &= mask;
-    }
-    
-    /* 最终处理 */
-    if (params->ref_out) {
-        crc = crc_reflect(crc, params->width);
+    while (len--)
+        c = _mm_crc32_u8((uint32_t)c, *p++);
+    return (uint32_t)c;
+}
+
+/* 长数据先折叠（每轮 64 字节，吞吐高于单条 crc32 指令链），剩余部分交给 crc32 指令 */
+CRC_TARGET("sse4.2,pclmul")
+static uint32_t crc32c_sse42_pclmul(uint32_t crc, const uint8_t *p, uint64_t len) {
+    uint8_t folded[16];
+    if (len < CRC_FOLD_MIN_LEN)
+        return crc32c_sse42(crc, p, len);
+    p = crc_fold_pclmul(&crc32c_fold, crc, p, &len, folded);
+    return crc32c_sse42(crc32c_sse42(0, folded, 16), p, len);
+}
+
+#endif /* CRC_HAVE_X86_64 */
+
+/* ==================== 运行时分发 ==================== */
+
+static uint32_t (*crc32_impl)(uint32_t, const uint8_t *, uint64_t) = crc32_update;
+static uint32_t (*crc32c_impl)(uint32_t, const uint8_t *, uint64_t) = crc32c_update;
+static uint64_t (*crc64_impl)(uint64_t, const uint8_t *, uint64_t) = crc64_update;
+
+/* 首次计算时选择实现；分发指针只在 pthread_once 内写入，之后只读 */
+static pthread_once_t crc_impl_once = PTHREAD_ONCE_INIT;
+
+/**
+ * @brief 根据 CPU 特性选择实现
+ */
+static void crc_select_impl(void) {
+#ifdef CRC_HAVE_X86_64
+    __builtin_cpu_init();
+    bool sse42 = __builtin_cpu_supports("sse4.2");
+    bool pclmul = __builtin_cpu_supports("pclmul");
+
+    if (pclmul) {
+        crc32_impl = crc32_pclmul;
+        crc64_impl = crc64_pclmul;
     }
-    crc ^= params->xor_out;
-    return crc & mask;
+    if (sse42)
+        crc32c_impl = pclmul ? crc32c_sse42_pclmul : crc32c_sse42;
+#endif
+}
+
+static inline void crc_init_once(void) {
+    pthread_once(&crc_impl_once, crc_select_impl);
 }
 
 /* ==================== 外部接口 ==================== */
 
 /**
- * @brief 初始化所有CRC表(只需调用一次)
+ * @brief 兼容旧接口：查表已在编译期生成，这里只提前完成实现选择（可重复调用，线程安全）
  */
 void crcTable_init(void) {
-    /* CRC16 (CCITT-FALSE) */
-    const CRCParams crc16_params = {
-        .width      = 16,
-        .poly       = CRC16_POLY,
-        .init       = 0xFFFF,
-        .ref_in     = false,
-        .ref_out    = false,
-        .xor_out    = 0x0000,
-        .slice_level = 2
-    };
-    crc_init_multi_table(crc16_table, &crc16_params);
-    
-    /* CRC32 (Ethernet, ZIP) */
-    const CRCParams crc32_params = {
-        .width      = 32,
-        .poly       = CRC32_POLY,
-        .init       = 0xFFFFFFFF,
-        .ref_in     = true,
-        .ref_out    = true,
-        .xor_out    = 0xFFFFFFFF,
-        .slice_level = 4
-    };
-    crc_init_multi_table(crc32_table, &crc32_params);
-    
-    /* CRC64 (Redis) */
-    const CRCParams crc64_params = {
-        .width      = 64,
-        .poly       = CRC64_POLY,
-        .init       = 0xFFFFFFFFFFFFFFFF,
-        .ref_in     = true,
-        .ref_out    = true,
-        .xor_out    = 0x0000000000000000,
-        .slice_level = 8
-    };
-    crc_init_multi_table(crc64_table, &crc64_params);
+    crc_init_once();
 }
 
 /**
@@ -337,16 +291,7 @@ void crcTable_init(void) {
  * @return 计算得到的CRC16值
  */
 uint16_t crc16(const unsigned char *buf, uint64_t len, uint16_t crc) {
-    const CRCParams params = {
-        .width      = 16,
-        .poly       = CRC16_POLY,
-        .init       = crc,
-        .ref_in     = false,
-        .ref_out    = false,
-        .xor_out    = 0x0000,
-        .slice_level = 2
-    };
-    return (uint16_t)crc_compute(buf, len, crc16_table, &params);
+    return crc16_update(crc, buf, len);
 }
 
 /**
@@ -357,16 +302,20 @@ uint16_t crc16(const unsigned char *buf, uint64_t len, uint16_t crc) {
  * @return 计算得到的CRC32值
  */
 uint32_t crc32(const unsigned char *buf, uint64_t len, uint32_t crc) {
-    const CRCParams params = {
-        .width      = 32,
-        .poly       = CRC32_POLY,
-        .init       = crc,
-        .ref_in     = true,
-        .ref_out    = true,
-        .xor_out    = 0xFFFFFFFF,
-        .slice_level = 4
-    };
-    return (uint32_t)crc_compute(buf, len, crc32_table, &params);
+    crc_init_once();
+    return crc32_impl(crc, buf, len) ^ 0xFFFFFFFF;
+}
+
+/**
+ * @brief 计算CRC32C值
+ * @param buf  输入数据指针
+ * @param len  数据长度
+ * @param crc  初始CRC值
+ * @return 计算得到的CRC32C值
+ */
+uint32_t crc32c(const unsigned char *buf, uint64_t len, uint32_t crc) {
+    crc_init_once();
+    return crc32c_impl(crc, buf, len) ^ 0xFFFFFFFF;
 }
 
 /**
@@ -377,14 +326,175 @@ uint32_t crc32(const unsigned char *buf, uint64_t len, uint32_t crc) {
  * @return 计算得到的CRC64值
  */
 uint64_t crc64(const unsigned char *buf, uint64_t len, uint64_t crc) {
-    const CRCParams params = {
-        .width      = 64,
-        .poly       = CRC64_POLY,
-        .init       = crc,
-        .ref_in     = true,
-        .ref_out    = true,
-        .xor_out    = 0x0000000000000000,
-        .slice_level = 8
-    };
-    return crc_compute(buf, len, crc64_table, &params);
-}
\ No newline at end of file
+    crc_init_once();
+    return crc64_impl(crc, buf, len);
+}
+
+/* ==================== 查表生成器 ==================== */
+
+#ifdef CRC_GEN_TABLES
+/*
+ * 修改多项式或切片数后重新生成 crc_table.h：
+ *   cc -DCRC_GEN_TABLES crc.c -o crc_gen && ./crc_gen > crc_table.h
+ */
+
+/**
+ * @brief 反射数据(低width位)
+ * @param data  要反射的数据
+ * @param width 要反射的位数
+ * @return 反射后的数据
+ */
+static inline uint64_t crc_reflect(uint64_t data, uint8_t width) {
+    uint64_t ret = 0;
+    for (uint8_t i = 0; i < width; i++) {
+        ret = (ret << 1) | (data & 0x01);
+        data >>= 1;
+    }
+    return ret;
+}
+
+/* 按位计算第 0 张表，其余各表由前一张表再推进一个零字节得到 */
+
+/* 反射CRC，poly 为反射形式 */
+#define CRC_DEFINE_REFLECTED_INIT(name, type, slices)                                 \
+    static void name##_init(type poly) {                                              \
+        for (int i = 0; i < 256; i++) {                                               \
+            type crc = (type)i;                                                       \
+            for (int j = 0; j < 8; j++)                                               \
+                crc = (type)((crc >> 1) ^ ((crc & 1) ? poly : 0));                    \
+            name##_table[0][i] = crc;                                                 \
+        }                                                                             \
+        for (int k = 1; k < (slices); k++) {                                          \
+            for (int i = 0; i < 256; i++) {                                           \
+                type prev = name##_table[k - 1][i];                                   \
+                name##_table[k][i] = (type)((prev >> 8) ^ name##_table[0][prev & 0xFF]); \
+            }                                                                         \
+        }                                                                             \
+    }
+
+/* 非反射CRC，poly 为正常形式（不含最高次项） */
+#define CRC_DEFINE_NORMAL_INIT(name, type, slices)                                    \
+    static void name##_init(type poly) {                                              \
+        const unsigned top = 8 * sizeof(type) - 8;                                    \
+        for (int i = 0; i < 256; i++) {                                               \
+            type crc = (type)((type)i << top);                                        \
+            for (int j = 0; j < 8; j++)                                               \
+                crc = (type)((crc << 1) ^ (((crc >> (top + 7)) & 1) ? poly : 0));     \
+            name##_table[0][i] = crc;                                                 \
+        }                                                                             \
+        for (int k = 1; k < (slices); k++) {                                          \
+            for (int i = 0; i < 256; i++) {                                           \
+                type prev = name##_table[k - 1][i];                                   \
+                name##_table[k][i] = (type)((type)(prev << 8) ^ name##_table[0][prev >> top]); \
+            }                                                                         \
+        }                                                                             \
+    }
+
+CRC_DEFINE_NORMAL_INIT(crc16, uint16_t, 8)
+CRC_DEFINE_REFLECTED_INIT(crc32, uint32_t, 16)
+CRC_DEFINE_REFLECTED_INIT(crc32c, uint32_t, 16)
+CRC_DEFINE_REFLECTED_INIT(crc64, uint64_t, 8)
+
+/**
+ * @brief 计算 x^n mod P（正常形式，P 为 width 位多项式，不含最高次项）
+ */
+static uint64_t crc_xpow_mod(unsigned n, uint64_t poly, uint8_t width) {
+    const uint64_t top = UINT64_C(1) << (width - 1);
+    const uint64_t mask = (width == 64) ? UINT64_MAX : ((UINT64_C(1) << width) - 1);
+    uint64_t r = 1;
+    while (n--) {
+        bool carry = (r & top) != 0;
+        r = (r << 1) & mask;
+        if (carry)
+            r ^= poly;
+    }
+    return r;
+}
+
+/**
+ * @brief 把次数小于 64 的多项式反射到 64 位（x^m 对应第 63-m 位）
+ */
+static uint64_t crc_reflect64(uint64_t v) {
+    return crc_reflect(v, 64);
+}
+
+/**
+ * @brief 生成折叠常数
+ *
+ * 128 位块 A 之后还有 D 位数据时，A·x^D ≡ A_hi·(x^(D+64) mod P)·x^(D-128) + A_lo·(x^D mod P)·x^(D-128)，
+ * 反射域的 64x64 无进位乘积比多项式位置少一位，因此常数取 x^(D+63)、x^(D-1) 后反射
+ */
+static void crc_init_fold(uint64_t k[4], uint64_t poly, uint8_t width) {
+    k[0] = crc_reflect64(crc_xpow_mod(512 + 63, poly, width));
+    k[1] = crc_reflect64(crc_xpow_mod(512 - 1, poly, width));
+    k[2] = crc_reflect64(crc_xpow_mod(128 + 63, poly, width));
+    k[3] = crc_reflect64(crc_xpow_mod(128 - 1, poly, width));
+}
+
+/**
+ * @brief 输出一组查表（表项按值输出，与主机字节序无关）
+ * @param get  读取 table[k][i]
+ * @param bytes 表项字节数
+ */
+static void crc_print_table(const char *type, const char *name, unsigned slices, unsigned bytes,
+                            uint64_t (*get)(unsigned k, unsigned i)) {
+    const unsigned per_line = (bytes == 2) ? 8 : (bytes == 4) ? 6 : 4;
+
+    printf("static const %s %s_table[%u][256] = {\n", type, name, slices);
+    for (unsigned k = 0; k < slices; k++) {
+        printf("  {\n");
+        for (unsigned i = 0; i < 256; i++) {
+            const char *sep = (i == 255) ? "\n" : (i % per_line == per_line - 1) ? ",\n" : ",";
+            printf("%s0x%0*llx%s", (i % per_line) ? " " : "    ", (int)(bytes * 2),
+                   (unsigned long long)get(k, i), sep);
+        }
+        printf("  }%s\n", (k == slices - 1) ? "" : ",");
+    }
+    printf("};\n\n");
+}
+
+static uint64_t crc16_get(unsigned k, unsigned i) { return crc16_table[k][i]; }
+static uint64_t crc32_get(unsigned k, unsigned i) { return crc32_table[k][i]; }
+static uint64_t crc32c_get(unsigned k, unsigned i) { return crc32c_table[k][i]; }
+static uint64_t crc64_get(unsigned k, unsigned i) { return crc64_table[k][i]; }
+
+/**
+ * @brief 输出折叠常数
+ */
+static void crc_print_fold(const char *name, uint64_t poly, uint8_t width) {
+    uint64_t k[4];
+    crc_init_fold(k, poly, width);
+    printf("static const CRCFoldConsts %s_fold = {\n", name);
+    printf("    0x%016llx, 0x%016llx,\n", (unsigned long long)k[0], (unsigned long long)k[1]);
+    printf("    0x%016llx, 0x%016llx\n", (unsigned long long)k[2], (unsigned long long)k[3]);
+    printf("};\n");
+}
+
+int main(void) {
+    crc16_init(CRC16_POLY);
+    crc32_init(CRC32_POLY);
+    crc32c_init(CRC32C_POLY);
+    crc64_init((uint64_t)crc_reflect(CRC64_POLY, 64));
+
+    printf("/***************************************************************\n"
+           "Copyright (c) 2022-2030, shisan233@sszc.live.\n"
+           "SPDX-License-Identifier: MIT\n"
+           "File:        crc_table.h\n"
+           "Description: CRC 查表与 PCLMULQDQ 折叠常数，仅供 crc.c 包含\n"
+           "    由 crc.c 生成，请勿手工修改：cc -DCRC_GEN_TABLES crc.c -o crc_gen && ./crc_gen > crc_table.h\n"
+           "*****************************************************************/\n\n");
+
+    crc_print_table("uint16_t", "crc16", 8, 2, crc16_get);
+    crc_print_table("uint32_t", "crc32", 16, 4, crc32_get);
+    crc_print_table("uint32_t", "crc32c", 16, 4, crc32c_get);
+    crc_print_table("uint64_t", "crc64", 8, 8, crc64_get);
+
+    printf("#ifdef CRC_HAVE_X86_64\n");
+    crc_print_fold("crc32", CRC32_POLY_NORMAL, 32);
+    crc_print_fold("crc32c", CRC32C_POLY_NORMAL, 32);
+    crc_print_fold("crc64", CRC64_POLY, 64);
+    printf("#endif\n");
+    return 0;
+}
+
+#endif /* CRC_GEN_TABLES */
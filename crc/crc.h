@@ -2,7 +2,7 @@
 Copyright (c) 2022-2030, shisan233@sszc.live.
 SPDX-License-Identifier: MIT 
 File:        crc.h
-Version:     1.0
+Version:     1.1
 Author:      cjx
 start date: 2025-05-23
 Description: CRC（循环冗余校验）​ 是一种基于多项式除法的错误检测算法，用于验证数据传输或存储的完整性。
@@ -12,6 +12,9 @@ Version history
 
 [序号]   |   [修改日期]   |   [修改者]   |   [修改内容]
 1           2025-05-23        cjx           create
+2           2026-10-18        cjx           新增CRC32C；x86-64下运行时选择SSE4.2/PCLMULQDQ实现，查表改为Slice-by-16
+3           2026-10-18        cjx           每种配置生成独立查表内核，去掉通用实现中逐字节的位宽/反射分支
+4           2026-10-18        cjx           查表改为编译期常量（crc_table.h），首次计算时线程安全地选择实现，不再需要手动初始化
 
 *****************************************************************/
 
@@ -22,8 +25,13 @@ Version history
    CRC-16/CCITT       16      0x1021              0xFFFF               false   false   0x0000
    CRC-16/Redis       16      0x1021              0x0000               false   false   0x0000
    CRC-32             32      0xEDB88320          0xFFFFFFFF           true    true    0xFFFFFFFF
+   CRC-32C            32      0x82F63B78          0xFFFFFFFF           true    true    0xFFFFFFFF
    CRC-64/ECMA        64      0x42F0E1EBA9FA5F    0xFFFFFFFFFFFFFFFF   false   false   0xFFFFFFFFFFFFFFFF
-   CRC-64/XZ(Redis)   64      0xAD93D23594C935A9  0xFFFFFFFFFFFFFFFF   true    true    0xFFFFFFFFFFFFFFFF
+   CRC-64/Jones(Redis) 64     0xAD93D23594C935A9  0x0000000000000000   true    true    0x0000000000000000
+
+   本文件实现：crc16 为 CRC-16/CCITT 系列，crc32 为 CRC-32，crc32c 为 CRC-32C，crc64 为 CRC-64/Jones(Redis)
+   校验值（"123456789"）：crc32(..., 0xFFFFFFFF) = 0xCBF43926，crc32c(..., 0xFFFFFFFF) = 0xE3069283，
+                          crc64(..., 0) = 0xE9C6D914C4B8D9CA
 */
 
 #include <stdint.h>
@@ -32,15 +40,16 @@ Version history
 extern "C" {
 #endif
 
-/* 使用前必须提前调用初始化一次（不在获取接口中做检测）
- 未进行线程安全功能添加，保证程序使用时初始化一次就行。
+/* 查表在编译期生成，各接口可直接调用，无需初始化
+ 保留该接口兼容旧代码：提前完成实现选择，可重复调用，线程安全（依赖 pthread_once）
 */
 void crcTable_init(void);
 
 /**
  * @brief CRC 计算函数：计算输入数据的 CRC 值
+ *        x86-64 下 crc32/crc64 在支持 PCLMULQDQ 时使用折叠算法，crc32c 在支持 SSE4.2 时使用 crc32 指令
  *
- * @param[in] crc               初始的 CRC 值（可参考配置表）
+ * @param[in] crc               初始的 CRC 值（可参考配置表）；crc32/crc32c 分段计算时传入上一段结果 ^ 0xFFFFFFFF
  * @param[in] buf               指向输入数据的缓冲区
  * @param[in] len               输入数据的长度（字节数）
  *
@@ -50,6 +59,8 @@ uint16_t crc16(const unsigned char *buf, uint64_t len, uint16_t crc);
 
 uint32_t crc32(const unsigned char *buf, uint64_t len, uint32_t crc);
 
+uint32_t crc32c(const unsigned char *buf, uint64_t len, uint32_t crc);
+
 uint64_t crc64(const unsigned char *buf, uint64_t len, uint64_t crc);
 
 
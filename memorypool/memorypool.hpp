@@ -23,8 +23,10 @@ Version history
 #include <cstdint>
 #include <memory>
 #include <mutex>
+#include <new>
 #include <optional>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 // ============================================================================
@@ -0,0 +1,351 @@
+/***************************************************************
+Copyright (c) 2022-2030, shisan233@sszc.live.
+SPDX-License-Identifier: MIT
+File:        connectionpool_test.cpp
+Version:     1.0
+Author:      cjx
+start date: 2026-10-18
+Description: ConnectionPool 后台维护功能测试（使用本地假连接，不依赖真实服务）
+             覆盖分批健康检查、并行建立初始连接、抖动退避重连、重连次数上限与移动语义
+             编译运行：g++ -std=c++17 -O1 connectionpool_test.cpp -o connectionpool_test -pthread && ./connectionpool_test
+Version history
+
+[序号]    |   [修改日期]  |   [修改者]   |   [修改内容]
+1            2026-10-18       cjx           create
+2            2026-10-18       cjx           重连次数上限与带自动清理的移动测试
+
+*****************************************************************/
+
+#include "objectpool.hpp"
+
+#include <cstdio>
+#include <string>
+
+using clock_type = std::chrono::steady_clock;
+using std::chrono::milliseconds;
+
+// ============================================================================
+// 假连接
+// ============================================================================
+
+struct FakeConnection
+{
+    static std::atomic<int> in_flight;
+    static std::atomic<int> peak_in_flight;
+    static std::atomic<int> fail_remaining;         // 之后多少次 connect 失败
+    static std::atomic<int> connect_delay_ms;
+    static std::mutex registry_mutex;
+    static std::vector<FakeConnection *> registry;  // 当前存活的连接
+    static std::vector<clock_type::time_point> attempts;
+
+    std::atomic<bool> valid{true};
+
+    static void reset_all()
+    {
+        in_flight = 0;
+        peak_in_flight = 0;
+        fail_remaining = 0;
+        connect_delay_ms = 0;
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        registry.clear();
+        attempts.clear();
+    }
+
+    // 把 n 个存活连接标记为失效，返回实际标记数
+    static size_t invalidate(size_t n)
+    {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        size_t marked = 0;
+        for (FakeConnection *conn : registry)
+        {
+            if (marked == n)
+                break;
+            if (conn->valid.exchange(false))
+                marked++;
+        }
+        return marked;
+    }
+
+    bool connect(const std::string &, int, const std::string &, const std::string &,
+                 const std::string &, std::chrono::seconds)
+    {
+        int now = ++in_flight;
+        int peak = peak_in_flight.load();
+        while (now > peak && !peak_in_flight.compare_exchange_weak(peak, now)) {}
+
+        {
+            std::lock_guard<std::mutex> lock(registry_mutex);
+            attempts.push_back(clock_type::now());
+        }
+        if (connect_delay_ms > 0)
+            std::this_thread::sleep_for(milliseconds(connect_delay_ms.load()));
+
+        bool ok = fail_remaining.fetch_sub(1) <= 0;
+        if (ok)
+        {
+            std::lock_guard<std::mutex> lock(registry_mutex);
+            registry.push_back(this);
+        }
+        --in_flight;
+        return ok;
+    }
+
+    void disconnect()
+    {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        registry.erase(std::remove(registry.begin(), registry.end(), this), registry.end());
+    }
+
+    bool is_valid() const { return valid; }
+    void reset() {}
+};
+
+std::atomic<int> FakeConnection::in_flight{0};
+std::atomic<int> FakeConnection::peak_in_flight{0};
+std::atomic<int> FakeConnection::fail_remaining{0};
+std::atomic<int> FakeConnection::connect_delay_ms{0};
+std::mutex FakeConnection::registry_mutex;
+std::vector<FakeConnection *> FakeConnection::registry;
+std::vector<clock_type::time_point> FakeConnection::attempts;
+
+using Pool = ConnectionPool<FakeConnection>;
+
+// ============================================================================
+// 测试工具
+// ============================================================================
+
+static int g_failures = 0;
+
+#define CHECK(cond)                                                             \
+    do                                                                          \
+    {                                                                           \
+        if (!(cond))                                                            \
+        {                                                                       \
+            std::printf("  FAILED %s:%d: %s\n", __FILE__, __LINE__, #cond);     \
+            g_failures++;                                                       \
+        }                                                                       \
+    } while (0)
+
+template <typename Pred>
+static bool wait_until(Pred pred, milliseconds timeout = milliseconds(2000))
+{
+    auto deadline = clock_type::now() + timeout;
+    while (!pred())
+    {
+        if (clock_type::now() >= deadline)
+            return false;
+        std::this_thread::sleep_for(milliseconds(2));
+    }
+    return true;
+}
+
+// 只测试后台行为：关闭重连、健康检查与自动清理，由各用例按需打开
+static Pool::ConnectionConfig base_config(size_t initial)
+{
+    Pool::ConnectionConfig cfg;
+    cfg.host = "fake";
+    cfg.initial_connections = initial;
+    cfg.max_connections = 32;
+    cfg.enable_auto_cleanup = false;
+    cfg.enable_retry = false;
+    cfg.health_check_interval = milliseconds(0);
+    return cfg;
+}
+
+// ============================================================================
+// 用例
+// ============================================================================
+
+static void test_parallel_connect()
+{
+    std::printf("parallel connect_initial\n");
+    FakeConnection::reset_all();
+    FakeConnection::connect_delay_ms = 40;
+
+    auto cfg = base_config(8);
+    cfg.connect_parallelism = 4;
+
+    auto start = clock_type::now();
+    Pool pool(cfg);
+    auto elapsed = clock_type::now() - start;
+
+    CHECK(pool.created() == 8);
+    CHECK(pool.available() == 8);
+    CHECK(FakeConnection::peak_in_flight > 1);
+    CHECK(FakeConnection::peak_in_flight <= 4);
+    // 串行需要 8 * 40ms，4 路并行约 2 * 40ms
+    CHECK(elapsed < milliseconds(8 * 40));
+}
+
+static void test_batched_validation()
+{
+    std::printf("batched validate_idle / sweep_idle\n");
+    FakeConnection::reset_all();
+
+    auto cfg = base_config(10);
+    cfg.health_check_batch = 3;
+    Pool pool(cfg);
+    CHECK(pool.available() == 10);
+
+    CHECK(FakeConnection::invalidate(4) == 4);
+
+    // 单批最多检查 batch_size 个空闲连接
+    size_t first = pool.validate_idle(3);
+    CHECK(first <= 3);
+    CHECK(pool.available() == 10 - first);
+
+    // sweep_idle 按 health_check_batch 分批检查全部空闲连接
+    size_t rest = pool.sweep_idle();
+    CHECK(first + rest == 4);
+    CHECK(pool.available() == 6);
+    CHECK(pool.created() == 6);
+}
+
+static void test_background_sweeper()
+{
+    std::printf("background health sweeper\n");
+    FakeConnection::reset_all();
+
+    auto cfg = base_config(6);
+    cfg.health_check_interval = milliseconds(10);
+    cfg.health_check_batch = 2;
+    Pool pool(cfg);
+
+    CHECK(FakeConnection::invalidate(3) == 3);
+    CHECK(wait_until([&] { return pool.available() == 3; }));
+    CHECK(pool.created() == 3);
+}
+
+static void test_reconnect_backoff()
+{
+    std::printf("jittered reconnect backoff\n");
+    FakeConnection::reset_all();
+    // 构造时 1 次 + 后台 3 次失败，第 5 次成功
+    FakeConnection::fail_remaining = 4;
+
+    auto cfg = base_config(1);
+    cfg.enable_retry = true;
+    cfg.retry_base_delay = milliseconds(10);
+    cfg.retry_max_delay = milliseconds(1000);
+    cfg.max_retries = 5;
+
+    auto start = clock_type::now();
+    Pool pool(cfg);
+    // 构造与借用路径都不睡眠重试
+    CHECK(clock_type::now() - start < milliseconds(50));
+    CHECK(pool.created() == 0);
+
+    CHECK(wait_until([&] { return pool.created() == 1; }));
+
+    std::vector<clock_type::time_point> attempts;
+    {
+        std::lock_guard<std::mutex> lock(FakeConnection::registry_mutex);
+        attempts = FakeConnection::attempts;
+    }
+    CHECK(attempts.size() == 5);
+    // attempts[1] 为后台首次立即重试，之后第 k 次失败后等待 [cap/2, cap]，cap = 10ms << (k - 1)
+    for (size_t i = 2; i < attempts.size(); ++i)
+    {
+        auto gap = std::chrono::duration_cast<std::chrono::microseconds>(attempts[i] - attempts[i - 1]);
+        auto min_gap = std::chrono::microseconds((10 << (i - 2)) * 1000 / 2);
+        CHECK(gap >= min_gap);
+    }
+}
+
+static void test_move_keeps_maintenance()
+{
+    std::printf("move keeps background maintenance\n");
+    FakeConnection::reset_all();
+    FakeConnection::fail_remaining = 1000;
+
+    auto cfg = base_config(2);
+    cfg.enable_retry = true;
+    cfg.retry_base_delay = milliseconds(1);
+    cfg.retry_max_delay = milliseconds(5);
+    cfg.max_retries = 100000;
+
+    Pool source(cfg);
+    Pool moved(std::move(source));
+    Pool assigned(base_config(0));
+    assigned = std::move(moved);
+
+    // 移动后由目标对象的维护线程继续重连
+    FakeConnection::fail_remaining = 0;
+    CHECK(wait_until([&] { return assigned.created() == 2; }));
+    CHECK(source.created() == 0);
+    CHECK(moved.created() == 0);
+
+    auto conn = assigned.borrow_auto();
+    CHECK(static_cast<bool>(conn));
+}
+
+static void test_retry_limit()
+{
+    std::printf("max_retries limits background reconnects\n");
+    FakeConnection::reset_all();
+    FakeConnection::fail_remaining = 1000;
+
+    auto cfg = base_config(2);
+    cfg.enable_retry = true;
+    cfg.retry_base_delay = milliseconds(1);
+    cfg.retry_max_delay = milliseconds(2);
+    cfg.max_retries = 3;
+
+    Pool pool(cfg);
+
+    // 构造时 2 次 + 后台 3 轮（每轮遇到首次失败即结束）后停止重连
+    auto attempt_count = [] {
+        std::lock_guard<std::mutex> lock(FakeConnection::registry_mutex);
+        return FakeConnection::attempts.size();
+    };
+    CHECK(wait_until([&] { return attempt_count() == 2 + 3; }));
+    std::this_thread::sleep_for(milliseconds(50));
+    CHECK(attempt_count() == 2 + 3);
+    CHECK(pool.created() == 0);
+
+    // 借用路径建连成功视为服务恢复，后台补足剩余连接
+    FakeConnection::fail_remaining = 0;
+    auto conn = pool.borrow_auto();
+    CHECK(static_cast<bool>(conn));
+    CHECK(wait_until([&] { return pool.created() == 2; }));
+}
+
+static void test_move_with_auto_cleanup()
+{
+    std::printf("move keeps idle cleanup\n");
+    FakeConnection::reset_all();
+
+    auto cfg = base_config(3);
+    cfg.enable_auto_cleanup = true;
+    cfg.idle_timeout = std::chrono::seconds(1);
+
+    // 源对象在移动后立即销毁，清理线程必须已迁移到目标对象
+    auto source = std::make_unique<Pool>(cfg);
+    Pool moved(std::move(*source));
+    source.reset();
+    Pool assigned(base_config(0));
+    assigned = std::move(moved);
+
+    CHECK(assigned.available() == 3);
+    CHECK(wait_until([&] { return assigned.created() == 0; }, milliseconds(3000)));
+    CHECK(moved.created() == 0);
+}
+
+int main()
+{
+    test_parallel_connect();
+    test_batched_validation();
+    test_background_sweeper();
+    test_reconnect_backoff();
+    test_move_keeps_maintenance();
+    test_retry_limit();
+    test_move_with_auto_cleanup();
+
+    if (g_failures > 0)
+    {
+        std::printf("%d check(s) failed\n", g_failures);
+        return 1;
+    }
+    std::printf("all passed\n");
+    return 0;
+}
@@ -11,6 +11,10 @@ Version history
 
 [序号]    |   [修改日期]  |   [修改者]   |   [修改内容]
 1            2026-04-14       cjx           create
+2            2026-10-18       cjx           自适应容量控制（预热/迟滞收缩）
+3            2026-10-18       cjx           按 CPU 分片的对象池 ShardedObjectPool
+4            2026-10-18       cjx           基于 FixedMemoryPool 的 slab 原地存储 SlabObjectPool
+5            2026-10-18       cjx           连接池后台分批健康检查、并行建连、抖动退避重连
 *****************************************************************/
 
 #ifndef OBJECT_POOL_HPP
@@ -19,22 +23,34 @@ Version history
 #include <algorithm>
 #include <atomic>
 #include <chrono>
+#include <cmath>
 #include <condition_variable>
+#include <cstddef>
+#include <exception>
 #include <functional>
 #include <iostream>
 #include <memory>
 #include <mutex>
 #include <optional>
 #include <queue>
+#include <random>
 #include <stdexcept>
 #include <thread>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+#include "../memorypool/memorypool.hpp"
+
 // ============================================================================
 // 调试宏
 // ============================================================================
 
+#undef POOL_ASSERT
 #ifdef OBJECT_POOL_DEBUG
 #include <cassert>
 #define POOL_ASSERT(cond, msg) assert((cond) && (msg))
@@ -42,6 +58,49 @@ Version history
 #define POOL_ASSERT(cond, msg) ((void)0)
 #endif
 
+// ============================================================================
+// 自适应容量配置
+// ============================================================================
+
+/// 后台控制器按采样周期观测借用速率、等待时间与命中率，
+/// 需求上升时提前预热对象，持续低谷时迟滞收缩；
+/// 启用后控制器所需的计数始终记录，不依赖 enable_stats
+struct ObjectPoolAdaptiveConfig
+{
+    /// 是否启用自适应容量控制
+    bool enabled = false;
+
+    /// 采样周期
+    std::chrono::milliseconds sample_interval = std::chrono::milliseconds(100);
+
+    /// 空闲对象下限（收缩不会低于此值）
+    size_t min_idle = 0;
+
+    /// 空闲对象上限（0 = 不限制，仍受 max_size 约束）
+    size_t max_idle = 0;
+
+    /// 单次预热的最大对象数（0 = 不限制）
+    size_t max_warm_step = 0;
+
+    /// EWMA 平滑系数（0~1，越大越灵敏）
+    double smoothing = 0.3;
+
+    /// 预热余量：目标空闲数 = 预测需求 * headroom
+    double headroom = 1.5;
+
+    /// 周期内命中率低于此值时立即补足未命中数
+    double target_hit_rate = 0.95;
+
+    /// 周期内平均等待时间超过此值视为需要扩容（0 = 不以等待时间判断）
+    std::chrono::milliseconds wait_threshold = std::chrono::milliseconds(0);
+
+    /// 空闲数超过 目标 * shrink_ratio 才计为低谷
+    double shrink_ratio = 2.0;
+
+    /// 连续多少个低谷周期后才收缩（迟滞）
+    size_t shrink_after = 20;
+};
+
 // ============================================================================
 // 对象池配置
 // ============================================================================
@@ -84,6 +143,9 @@ struct ObjectPoolConfig
     
     /// 泄漏检测回调（析构时如有未归还对象则调用）
     std::function<void(size_t)> leak_callback = nullptr;
+
+    /// 自适应容量控制
+    ObjectPoolAdaptiveConfig adaptive;
 };
 
 // ============================================================================
@@ -106,6 +168,11 @@ struct ObjectPoolStats
     size_t peak_waiters = 0;            // 峰值等待线程数
     double hit_rate = 0.0;              // 命中率
     double avg_idle_time_ms = 0.0;      // 平均空闲时间（毫秒）
+    double avg_wait_time_ms = 0.0;      // 阻塞借用平均耗时（含借用时创建，毫秒）
+    size_t total_prewarmed = 0;         // 自适应控制预热的对象数
+    size_t total_adaptive_shrunk = 0;   // 自适应控制收缩的对象数
+    size_t adaptive_target_idle = 0;    // 自适应控制当前目标空闲数
+    size_t total_steals = 0;            // 分片池从相邻分片窃取的次数
 };
 
 // ============================================================================
@@ -182,9 +249,15 @@ private:
 // 通用对象池
 // ============================================================================
 
+template <typename T>
+class ShardedObjectPool;
+
 template <typename T>
 class ObjectPool
 {
+    // 分片池由统一的后台线程驱动各分片的自适应采样
+    friend class ShardedObjectPool<T>;
+
 public:
     using Config = ObjectPoolConfig<T>;
 
@@ -202,6 +275,7 @@ public:
         , m_max_idle_time(cfg.max_idle_time)
         , m_enable_stats(cfg.enable_stats)
         , m_leak_callback(cfg.leak_callback)
+        , m_adaptive(cfg.adaptive)
     {
         if (!m_factory)
         {
@@ -220,6 +294,12 @@ public:
         {
             start_cleanup_thread(cfg.cleanup_interval);
         }
+
+        // 启动自适应容量控制
+        if (m_adaptive.enabled)
+        {
+            start_adaptive_thread();
+        }
     }
 
     // 创建默认配置的池（使用 new/delete）
@@ -235,7 +315,8 @@ public:
 
     ~ObjectPool()
     {
-        // 停止清理线程
+        // 停止后台线程
+        stop_adaptive_thread();
         stop_cleanup_thread();
 
         std::unique_lock<std::mutex> lock(m_mutex);
@@ -275,6 +356,7 @@ public:
         , m_max_idle_time(other.m_max_idle_time)
         , m_enable_stats(other.m_enable_stats)
         , m_leak_callback(std::move(other.m_leak_callback))
+        , m_adaptive(other.m_adaptive)
         , m_created_count(other.m_created_count.exchange(0))
         , m_borrowed_count(other.m_borrowed_count.exchange(0))
         , m_free_count(other.m_free_count.exchange(0))
@@ -289,14 +371,29 @@ public:
         , m_idle_sample_count(other.m_idle_sample_count.exchange(0))
         , m_current_waiters(other.m_current_waiters.exchange(0))
         , m_peak_waiters(other.m_peak_waiters.exchange(0))
+        , m_total_wait_time_us(other.m_total_wait_time_us.exchange(0))
+        , m_wait_sample_count(other.m_wait_sample_count.exchange(0))
+        , m_total_prewarmed(other.m_total_prewarmed.exchange(0))
+        , m_total_adaptive_shrunk(other.m_total_adaptive_shrunk.exchange(0))
     {
-        std::lock_guard<std::mutex> lock(other.m_mutex);
-        m_pool = std::move(other.m_pool);
-        
-        m_cleanup_running = other.m_cleanup_running.exchange(false);
-        if (other.m_cleanup_thread.joinable())
+        // 后台线程持有 other 的 this，需先停止再在新对象上重启
+        bool adaptive_was_running = other.m_adaptive_thread.joinable();
+        bool cleanup_was_running = other.m_cleanup_thread.joinable();
+        other.stop_adaptive_thread();
+        other.stop_cleanup_thread();
+
+        {
+            std::lock_guard<std::mutex> lock(other.m_mutex);
+            m_pool = std::move(other.m_pool);
+        }
+
+        if (cleanup_was_running)
         {
-            other.m_cleanup_thread.detach();
+            start_cleanup_thread(other.m_cleanup_interval);
+        }
+        if (adaptive_was_running)
+        {
+            start_adaptive_thread();
         }
     }
 
@@ -304,45 +401,67 @@ public:
     {
         if (this != &other)
         {
+            // 与移动构造一致：后台线程持有 other 的 this，停止后在本对象上重启
+            bool adaptive_was_running = other.m_adaptive_thread.joinable();
+            bool cleanup_was_running = other.m_cleanup_thread.joinable();
+            stop_adaptive_thread();
+            other.stop_adaptive_thread();
             stop_cleanup_thread();
-            
-            std::lock_guard<std::mutex> lock(m_mutex);
-            std::lock_guard<std::mutex> other_lock(other.m_mutex);
-            
-            // 清理当前资源
-            while (!m_pool.empty())
+            other.stop_cleanup_thread();
+
             {
-                m_deleter(m_pool.front().obj);
-                m_pool.pop();
+                std::lock_guard<std::mutex> lock(m_mutex);
+                std::lock_guard<std::mutex> other_lock(other.m_mutex);
+
+                // 清理当前资源
+                while (!m_pool.empty())
+                {
+                    m_deleter(m_pool.front().obj);
+                    m_pool.pop();
+                }
+
+                // 移动资源
+                m_factory = std::move(other.m_factory);
+                m_resetter = std::move(other.m_resetter);
+                m_validator = std::move(other.m_validator);
+                m_deleter = std::move(other.m_deleter);
+                m_max_size = other.m_max_size;
+                m_max_waiters = other.m_max_waiters;
+                m_max_idle_time = other.m_max_idle_time;
+                m_enable_stats = other.m_enable_stats;
+                m_leak_callback = std::move(other.m_leak_callback);
+                m_adaptive = other.m_adaptive;
+                m_pool = std::move(other.m_pool);
+
+                // 移动原子变量
+                m_created_count = other.m_created_count.exchange(0);
+                m_borrowed_count = other.m_borrowed_count.exchange(0);
+                m_free_count = other.m_free_count.exchange(0);
+                m_peak_borrowed = other.m_peak_borrowed.exchange(0);
+                m_total_borrows = other.m_total_borrows.exchange(0);
+                m_total_returns = other.m_total_returns.exchange(0);
+                m_total_destroyed = other.m_total_destroyed.exchange(0);
+                m_total_timeouts = other.m_total_timeouts.exchange(0);
+                m_total_creates_on_borrow = other.m_total_creates_on_borrow.exchange(0);
+                m_total_create_failures = other.m_total_create_failures.exchange(0);
+                m_total_idle_time_ms = other.m_total_idle_time_ms.exchange(0);
+                m_idle_sample_count = other.m_idle_sample_count.exchange(0);
+                m_current_waiters = other.m_current_waiters.exchange(0);
+                m_peak_waiters = other.m_peak_waiters.exchange(0);
+                m_total_wait_time_us = other.m_total_wait_time_us.exchange(0);
+                m_wait_sample_count = other.m_wait_sample_count.exchange(0);
+                m_total_prewarmed = other.m_total_prewarmed.exchange(0);
+                m_total_adaptive_shrunk = other.m_total_adaptive_shrunk.exchange(0);
+            }
+
+            if (cleanup_was_running)
+            {
+                start_cleanup_thread(other.m_cleanup_interval);
+            }
+            if (adaptive_was_running)
+            {
+                start_adaptive_thread();
             }
-    
-            // 移动资源
-            m_factory = std::move(other.m_factory);
-            m_resetter = std::move(other.m_resetter);
-            m_validator = std::move(other.m_validator);
-            m_deleter = std::move(other.m_deleter);
-            m_max_size = other.m_max_size;
-            m_max_waiters = other.m_max_waiters;
-            m_max_idle_time = other.m_max_idle_time;
-            m_enable_stats = other.m_enable_stats;
-            m_leak_callback = std::move(other.m_leak_callback);
-            m_pool = std::move(other.m_pool);
-            
-            // 移动原子变量
-            m_created_count = other.m_created_count.exchange(0);
-            m_borrowed_count = other.m_borrowed_count.exchange(0);
-            m_free_count = other.m_free_count.exchange(0);
-            m_peak_borrowed = other.m_peak_borrowed.exchange(0);
-            m_total_borrows = other.m_total_borrows.exchange(0);
-            m_total_returns = other.m_total_returns.exchange(0);
-            m_total_destroyed = other.m_total_destroyed.exchange(0);
-            m_total_timeouts = other.m_total_timeouts.exchange(0);
-            m_total_creates_on_borrow = other.m_total_creates_on_borrow.exchange(0);
-            m_total_create_failures = other.m_total_create_failures.exchange(0);
-            m_total_idle_time_ms = other.m_total_idle_time_ms.exchange(0);
-            m_idle_sample_count = other.m_idle_sample_count.exchange(0);
-            m_current_waiters = other.m_current_waiters.exchange(0);
-            m_peak_waiters = other.m_peak_waiters.exchange(0);
         }
         return *this;
     }
@@ -385,7 +504,7 @@ public:
                 m_created_count++;
                 m_borrowed_count++;
                 m_total_borrows++;
-                if (m_enable_stats)
+                if (tracks_demand())
                     m_total_creates_on_borrow++;
                 update_peak();
                 return obj;
@@ -400,6 +519,17 @@ public:
         return std::nullopt;
     }
 
+    // 仅从空闲对象中获取（池空时不创建新对象）
+    std::optional<T *> try_take_idle()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (m_pool.empty())
+            return std::nullopt;
+
+        return take_from_pool_impl();
+    }
+
     // ========================================================================
     // RAII 包装器
     // ========================================================================
@@ -565,40 +695,10 @@ public:
     }
 
     // 预热对象（预分配并初始化）
+    // 创建与初始化在锁外进行，不阻塞并发的借用/归还
     bool warm_up(size_t count, std::function<void(T *)> initializer = nullptr)
     {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        
-        size_t created = 0;
-        for (size_t i = 0; i < count; ++i)
-        {
-            if (m_max_size > 0 && m_created_count >= m_max_size)
-                break;
-
-            T *obj = create_object_safe();
-            if (!obj)
-                break;
-
-            if (initializer)
-            {
-                try
-                {
-                    initializer(obj);
-                }
-                catch (...)
-                {
-                    m_deleter(obj);
-                    throw;
-                }
-            }
-
-            m_pool.push({obj, std::chrono::steady_clock::now()});
-            m_created_count++;
-            m_free_count++;
-            created++;
-        }
-
-        return created > 0;
+        return warm_up_impl(count, initializer) > 0;
     }
 
     /// 收缩到指定大小
@@ -638,6 +738,67 @@ public:
         return reap_idle_objects_impl();
     }
 
+    /// 分批验证空闲对象（batch_size = 0 表示全部），返回销毁数
+    /// 验证与销毁在锁外进行，不阻塞借用路径；验证通过的对象保留原空闲时间回到队尾
+    size_t validate_idle(size_t batch_size = 0)
+    {
+        std::vector<PooledObjectEntry> batch;
+        std::function<bool(T *)> validator;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_validator)
+                return 0;
+            validator = m_validator;
+
+            size_t n = batch_size == 0 ? m_pool.size() : std::min(batch_size, m_pool.size());
+            batch.reserve(n);
+            for (size_t i = 0; i < n; ++i)
+            {
+                batch.push_back(m_pool.front());
+                m_pool.pop();
+                m_free_count--;
+            }
+        }
+
+        if (batch.empty())
+            return 0;
+
+        std::vector<T *> invalid;
+        auto valid_end = std::stable_partition(batch.begin(), batch.end(),
+            [&validator](const PooledObjectEntry &entry) {
+                try
+                {
+                    return validator(entry.obj);
+                }
+                catch (...)
+                {
+                    return false;
+                }
+            });
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (auto it = batch.begin(); it != valid_end; ++it)
+            {
+                m_pool.push(*it);
+                m_free_count++;
+            }
+            for (auto it = valid_end; it != batch.end(); ++it)
+            {
+                invalid.push_back(it->obj);
+                m_created_count--;
+                m_total_destroyed++;
+            }
+        }
+        m_cv.notify_all();
+
+        for (T *obj : invalid)
+        {
+            m_deleter(obj);
+        }
+        return invalid.size();
+    }
+
     // ========================================================================
     // 统计信息
     // ========================================================================
@@ -695,6 +856,15 @@ public:
         stats.avg_idle_time_ms = samples > 0 
             ? static_cast<double>(m_total_idle_time_ms.load()) / samples 
             : 0.0;
+
+        size_t wait_samples = m_wait_sample_count.load();
+        stats.avg_wait_time_ms = wait_samples > 0
+            ? static_cast<double>(m_total_wait_time_us.load()) / 1000.0 / wait_samples
+            : 0.0;
+
+        stats.total_prewarmed = m_total_prewarmed.load();
+        stats.total_adaptive_shrunk = m_total_adaptive_shrunk.load();
+        stats.adaptive_target_idle = m_adaptive_target_idle.load();
         
         return stats;
     }
@@ -750,6 +920,9 @@ private:
 
     T *borrow_impl(std::chrono::milliseconds timeout, bool use_timeout)
     {
+        auto start = tracks_demand() ? std::chrono::steady_clock::now()
+                                     : std::chrono::steady_clock::time_point();
+
         std::unique_lock<std::mutex> lock(m_mutex);
 
         // 检查等待队列限制
@@ -810,7 +983,9 @@ private:
         // 从池中获取
         if (!m_pool.empty())
         {
-            return take_from_pool_impl();
+            T *obj = take_from_pool_impl();
+            record_wait_time(start);
+            return obj;
         }
 
         // 创建新对象（统一在此处处理统计）
@@ -822,9 +997,10 @@ private:
                 m_created_count++;
                 m_borrowed_count++;
                 m_total_borrows++;
-                if (m_enable_stats)
+                if (tracks_demand())
                     m_total_creates_on_borrow++;
                 update_peak();
+                record_wait_time(start);
                 return obj;
             }
             else
@@ -838,9 +1014,15 @@ private:
         return nullptr;
     }
 
+    // 未命中、等待者与等待时间是自适应控制器的输入，启用控制器时即使关闭统计也要记录
+    bool tracks_demand() const noexcept
+    {
+        return m_enable_stats || m_adaptive.enabled;
+    }
+
     void increment_waiters()
     {
-        if (!m_enable_stats)
+        if (!tracks_demand())
             return;
         
         size_t current = m_current_waiters.fetch_add(1) + 1;
@@ -855,10 +1037,21 @@ private:
 
     void decrement_waiters()
     {
-        if (m_enable_stats)
+        if (tracks_demand())
             m_current_waiters--;
     }
 
+    void record_wait_time(std::chrono::steady_clock::time_point start)
+    {
+        if (!tracks_demand())
+            return;
+
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start);
+        m_total_wait_time_us += static_cast<uint64_t>(elapsed.count());
+        m_wait_sample_count++;
+    }
+
     T *take_from_pool_impl()
     {
         auto entry = m_pool.front();
@@ -932,6 +1125,73 @@ private:
         return created > 0;
     }
 
+    // 先在锁内预留容量，再在锁外创建，最后入池
+    size_t warm_up_impl(size_t count, const std::function<void(T *)> &initializer)
+    {
+        size_t reserved = 0;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            reserved = count;
+            if (m_max_size > 0)
+            {
+                size_t created = m_created_count.load();
+                reserved = created >= m_max_size ? 0 : std::min(count, m_max_size - created);
+            }
+            m_created_count += reserved;
+        }
+
+        std::vector<T *> objs;
+        objs.reserve(reserved);
+        size_t failures = 0;
+        std::exception_ptr error;
+        for (size_t i = 0; i < reserved; ++i)
+        {
+            T *obj = create_object_safe();
+            if (!obj)
+            {
+                failures++;
+                break;
+            }
+
+            if (initializer)
+            {
+                try
+                {
+                    initializer(obj);
+                }
+                catch (...)
+                {
+                    m_deleter(obj);
+                    error = std::current_exception();
+                    break;
+                }
+            }
+            objs.push_back(obj);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto now = std::chrono::steady_clock::now();
+            for (T *obj : objs)
+            {
+                m_pool.push({obj, now});
+                m_free_count++;
+            }
+            // 归还未使用的预留额度
+            m_created_count -= reserved - objs.size();
+            if (m_enable_stats)
+                m_total_create_failures += failures;
+        }
+
+        // 预留期间等待者可能因容量已满而阻塞，此处统一唤醒
+        m_cv.notify_all();
+
+        if (error)
+            std::rethrow_exception(error);
+
+        return objs.size();
+    }
+
     void shrink_to_impl(size_t target_size)
     {
         if (m_pool.size() <= target_size)
@@ -1023,28 +1283,183 @@ private:
             interval = m_max_idle_time / 2;
         }
 
+        // 条件变量等待而非 sleep，停止（析构、移动）时无需等满一个周期
+        m_cleanup_interval = interval;
         m_cleanup_running = true;
         m_cleanup_thread = std::thread([this, interval]() {
-            while (m_cleanup_running.load(std::memory_order_acquire))
+            std::unique_lock<std::mutex> lock(m_cleanup_mutex);
+            while (m_cleanup_running)
             {
-                std::this_thread::sleep_for(interval);
-                if (m_cleanup_running.load(std::memory_order_acquire))
-                {
-                    reap_idle_objects();
-                }
+                m_cleanup_cv.wait_for(lock, interval, [this] { return !m_cleanup_running; });
+                if (!m_cleanup_running)
+                    break;
+
+                lock.unlock();
+                reap_idle_objects();
+                lock.lock();
             }
         });
     }
 
     void stop_cleanup_thread()
     {
-        m_cleanup_running.store(false, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> lock(m_cleanup_mutex);
+            m_cleanup_running = false;
+        }
+        m_cleanup_cv.notify_all();
         if (m_cleanup_thread.joinable())
         {
             m_cleanup_thread.join();
         }
     }
 
+    // ------------------------------------------------------------------------
+    // 自适应容量控制
+    // ------------------------------------------------------------------------
+
+    // 控制器采样状态，仅由控制器线程访问
+    struct AdaptiveState
+    {
+        size_t last_borrows = 0;
+        size_t last_misses = 0;
+        size_t last_borrowed = 0;
+        uint64_t last_wait_us = 0;
+        size_t last_wait_samples = 0;
+        double ewma_demand = 0.0;   // 每周期新增并发需求
+        size_t lull_ticks = 0;
+    };
+
+    void start_adaptive_thread()
+    {
+        auto interval = m_adaptive.sample_interval;
+        if (interval <= std::chrono::milliseconds::zero())
+        {
+            interval = std::chrono::milliseconds(100);
+        }
+
+        m_adaptive_running = true;
+        m_adaptive_thread = std::thread([this, interval]() {
+            AdaptiveState state;
+            state.last_borrows = m_total_borrows.load();
+            state.last_misses = m_total_creates_on_borrow.load();
+            state.last_borrowed = m_borrowed_count.load();
+
+            std::unique_lock<std::mutex> lock(m_adaptive_mutex);
+            while (m_adaptive_running)
+            {
+                m_adaptive_cv.wait_for(lock, interval, [this] { return !m_adaptive_running; });
+                if (!m_adaptive_running)
+                    break;
+
+                lock.unlock();
+                adaptive_tick(state);
+                lock.lock();
+            }
+        });
+    }
+
+    void stop_adaptive_thread()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_adaptive_mutex);
+            m_adaptive_running = false;
+        }
+        m_adaptive_cv.notify_all();
+        if (m_adaptive_thread.joinable())
+        {
+            m_adaptive_thread.join();
+        }
+    }
+
+    void adaptive_tick(AdaptiveState &state)
+    {
+        ObjectPoolStats stats = get_stats();
+        uint64_t wait_us = m_total_wait_time_us.load();
+        size_t wait_samples = m_wait_sample_count.load();
+
+        size_t borrows = stats.total_borrows - state.last_borrows;
+        size_t misses = stats.total_creates_on_borrow - state.last_misses;
+        // 按有符号差值计算：分片池中单个分片的借出计数可能回绕
+        auto borrowed_delta = static_cast<std::ptrdiff_t>(stats.borrowed - state.last_borrowed);
+        size_t growth = borrowed_delta > 0 ? static_cast<size_t>(borrowed_delta) : 0;
+        double tick_hit_rate = borrows > 0
+            ? 1.0 - static_cast<double>(misses) / borrows
+            : 1.0;
+        double tick_wait_ms = wait_samples > state.last_wait_samples
+            ? static_cast<double>(wait_us - state.last_wait_us) / 1000.0 /
+                  (wait_samples - state.last_wait_samples)
+            : 0.0;
+
+        state.last_borrows = stats.total_borrows;
+        state.last_misses = stats.total_creates_on_borrow;
+        state.last_borrowed = stats.borrowed;
+        state.last_wait_us = wait_us;
+        state.last_wait_samples = wait_samples;
+
+        // 预测下一周期的新增需求：并发增长与借用时创建取较大者
+        double alpha = std::clamp(m_adaptive.smoothing, 0.0, 1.0);
+        double demand = static_cast<double>(std::max(growth, misses));
+        state.ewma_demand = alpha * demand + (1.0 - alpha) * state.ewma_demand;
+
+        size_t target = static_cast<size_t>(std::ceil(state.ewma_demand * m_adaptive.headroom));
+
+        // 命中率不足或等待过久时至少补足本周期的缺口
+        bool pressured = tick_hit_rate < m_adaptive.target_hit_rate ||
+                         stats.current_waiters > 0 ||
+                         (m_adaptive.wait_threshold > std::chrono::milliseconds::zero() &&
+                          tick_wait_ms > static_cast<double>(m_adaptive.wait_threshold.count()));
+        if (pressured)
+        {
+            target = std::max(target, misses + stats.current_waiters);
+        }
+
+        target = std::max(target, m_adaptive.min_idle);
+        if (m_adaptive.max_idle > 0)
+        {
+            target = std::min(target, m_adaptive.max_idle);
+        }
+        m_adaptive_target_idle = target;
+
+        if (stats.available < target)
+        {
+            state.lull_ticks = 0;
+
+            size_t step = target - stats.available;
+            if (m_adaptive.max_warm_step > 0)
+            {
+                step = std::min(step, m_adaptive.max_warm_step);
+            }
+
+            size_t warmed = 0;
+            try
+            {
+                warmed = warm_up_impl(step, nullptr);
+            }
+            catch (...) {}
+            m_total_prewarmed += warmed;
+            return;
+        }
+
+        // 迟滞：空闲数须持续高于 目标 * shrink_ratio 才收缩，避免在阈值附近抖动
+        double high_water = std::max(static_cast<double>(target) * m_adaptive.shrink_ratio,
+                                     static_cast<double>(target) + 1.0);
+        if (pressured || static_cast<double>(stats.available) <= high_water)
+        {
+            state.lull_ticks = 0;
+            return;
+        }
+
+        if (++state.lull_ticks < m_adaptive.shrink_after)
+            return;
+
+        state.lull_ticks = 0;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        size_t before = m_pool.size();
+        shrink_to_impl(target);
+        m_total_adaptive_shrunk += before - m_pool.size();
+    }
+
 private:
     // 配置
     std::function<T *()> m_factory;
@@ -1056,6 +1471,7 @@ private:
     std::chrono::milliseconds m_max_idle_time;
     bool m_enable_stats;
     std::function<void(size_t)> m_leak_callback;
+    ObjectPoolAdaptiveConfig m_adaptive;
 
     // 池状态
     std::queue<PooledObjectEntry> m_pool;
@@ -1077,27 +1493,1218 @@ private:
     std::atomic<size_t> m_idle_sample_count{0};
     std::atomic<size_t> m_current_waiters{0};
     std::atomic<size_t> m_peak_waiters{0};
+    std::atomic<uint64_t> m_total_wait_time_us{0};
+    std::atomic<size_t> m_wait_sample_count{0};
+    std::atomic<size_t> m_total_prewarmed{0};
+    std::atomic<size_t> m_total_adaptive_shrunk{0};
+    std::atomic<size_t> m_adaptive_target_idle{0};
 
     // 后台清理
-    std::atomic<bool> m_cleanup_running{false};
+    bool m_cleanup_running = false;
+    std::chrono::milliseconds m_cleanup_interval{0};
+    std::mutex m_cleanup_mutex;
+    std::condition_variable m_cleanup_cv;
     std::thread m_cleanup_thread;
+
+    // 自适应容量控制
+    bool m_adaptive_running = false;
+    std::mutex m_adaptive_mutex;
+    std::condition_variable m_adaptive_cv;
+    std::thread m_adaptive_thread;
 };
 
 // ============================================================================
-// 线程本地对象池
+// 分片对象池
 // ============================================================================
 
+/// 分片选择策略
+enum class ShardSelect
+{
+    cpu,        // 按当前 CPU 选择（Linux 使用 sched_getcpu，其他平台退化为线程 id）
+    thread      // 按线程 id 哈希选择
+};
+
+/// 将对象分散到 N 个子池，借用/归还只竞争当前 CPU 所在分片的锁；
+/// 分片空时从相邻分片窃取，max_size 为所有分片共享的全局上限。
+/// 对象归还到当前线程所在分片（随使用方迁移），因此单个分片的借出计数
+/// 可能为负（无符号回绕），只有汇总后的统计才有意义。
+/// 自动清理与自适应控制由整个池共用的一个后台线程完成，
+/// adaptive 的 min_idle/max_idle/max_warm_step 为全池总量，按分片均分
 template <typename T>
-class ThreadLocalObjectPool
+class ShardedObjectPool
 {
 public:
-    explicit ThreadLocalObjectPool(size_t local_size = 8)
-        : m_local_size(local_size) {}
+    using Config = ObjectPoolConfig<T>;
 
-    ~ThreadLocalObjectPool()
-    {
-        clear();
-    }
+    // ========================================================================
+    // 构造与析构
+    // ========================================================================
+
+    /// shard_count = 0 时使用硬件线程数
+    explicit ShardedObjectPool(const Config &cfg, size_t shard_count = 0,
+                               ShardSelect select = ShardSelect::cpu)
+        : m_deleter(cfg.deleter)
+        , m_max_size(cfg.max_size)
+        , m_max_waiters(cfg.max_waiters)
+        , m_enable_stats(cfg.enable_stats)
+        , m_adaptive_enabled(cfg.adaptive.enabled)
+        , m_leak_callback(cfg.leak_callback)
+        , m_select(select)
+    {
+        if (!cfg.factory)
+        {
+            throw std::invalid_argument("ShardedObjectPool: factory function is required");
+        }
+        if (!cfg.deleter)
+        {
+            throw std::invalid_argument("ShardedObjectPool: deleter function is required");
+        }
+
+        if (shard_count == 0)
+        {
+            shard_count = std::max<size_t>(1, std::thread::hardware_concurrency());
+        }
+
+        // 子池不设上限，由全局预算计数统一约束；
+        // 子池不启动各自的清理/控制线程，由本池的维护线程统一处理
+        Config shard_cfg = cfg;
+        shard_cfg.max_size = 0;
+        shard_cfg.max_waiters = 0;
+        shard_cfg.leak_callback = nullptr;
+        shard_cfg.enable_auto_cleanup = false;
+        shard_cfg.adaptive.enabled = false;
+        shard_cfg.factory = [this, factory = cfg.factory]() -> T * {
+            if (!acquire_budget())
+                return nullptr;
+            T *obj = factory();
+            if (!obj)
+                release_budget();
+            return obj;
+        };
+        shard_cfg.deleter = [this](T *p) {
+            m_deleter(p);
+            release_budget();
+        };
+
+        m_shards.reserve(shard_count);
+        for (size_t i = 0; i < shard_count; ++i)
+        {
+            // 初始对象均分到各分片
+            shard_cfg.initial_size = split(cfg.initial_size, shard_count, i);
+            m_shards.push_back(std::make_unique<ObjectPool<T>>(shard_cfg));
+
+            // 子池只记录控制器输入（等待由 borrow_impl 记到本地分片），采样由维护线程调用
+            if (cfg.adaptive.enabled)
+            {
+                ObjectPoolAdaptiveConfig adaptive = cfg.adaptive;
+                adaptive.min_idle = split(cfg.adaptive.min_idle, shard_count, i);
+                if (cfg.adaptive.max_idle > 0)
+                    adaptive.max_idle = std::max<size_t>(1, split(cfg.adaptive.max_idle, shard_count, i));
+                if (cfg.adaptive.max_warm_step > 0)
+                    adaptive.max_warm_step = std::max<size_t>(1, split(cfg.adaptive.max_warm_step, shard_count, i));
+                m_shards.back()->m_adaptive = adaptive;
+            }
+        }
+
+        auto cleanup_interval = std::chrono::milliseconds::zero();
+        if (cfg.enable_auto_cleanup && cfg.max_idle_time > std::chrono::milliseconds::zero())
+        {
+            cleanup_interval = cfg.cleanup_interval > std::chrono::milliseconds::zero()
+                ? cfg.cleanup_interval
+                : cfg.max_idle_time / 2;
+        }
+        auto sample_interval = std::chrono::milliseconds::zero();
+        if (cfg.adaptive.enabled)
+        {
+            m_adaptive_states.resize(shard_count);
+            sample_interval = cfg.adaptive.sample_interval > std::chrono::milliseconds::zero()
+                ? cfg.adaptive.sample_interval
+                : std::chrono::milliseconds(100);
+        }
+        if (cleanup_interval > std::chrono::milliseconds::zero() ||
+            sample_interval > std::chrono::milliseconds::zero())
+        {
+            start_maintenance_thread(cleanup_interval, sample_interval);
+        }
+    }
+
+    ~ShardedObjectPool()
+    {
+        stop_maintenance_thread();
+
+        // 子池删除器引用本对象的预算计数，需先于其他成员销毁
+        m_shards.clear();
+
+        size_t leaked = m_borrowed_count.load();
+        if (leaked > 0 && m_leak_callback)
+        {
+            m_leak_callback(leaked);
+        }
+    }
+
+    // 子池持有 this，禁止拷贝与移动
+    ShardedObjectPool(const ShardedObjectPool &) = delete;
+    ShardedObjectPool &operator=(const ShardedObjectPool &) = delete;
+
+    // ========================================================================
+    // 借用接口
+    // ========================================================================
+
+    // 阻塞借用（无限等待）
+    T *borrow()
+    {
+        return borrow_impl(std::chrono::milliseconds::zero(), false);
+    }
+
+    // 带超时的借用
+    template <typename Rep, typename Period>
+    T *borrow_for(const std::chrono::duration<Rep, Period> &timeout)
+    {
+        return borrow_impl(
+            std::chrono::duration_cast<std::chrono::milliseconds>(timeout),
+            true);
+    }
+
+    // 非阻塞借用（本分片 -> 相邻分片 -> 新建）
+    std::optional<T *> try_borrow()
+    {
+        T *obj = try_acquire(current_shard());
+        if (!obj)
+            return std::nullopt;
+        on_borrowed();
+        return obj;
+    }
+
+    // 自动归还的包装器（阻塞）
+    PooledObject<T> borrow_auto()
+    {
+        T *obj = borrow();
+        return PooledObject<T>(obj, [this](T *p) { return_object(p); });
+    }
+
+    // 自动归还的包装器（带超时）
+    template <typename Rep, typename Period>
+    PooledObject<T> borrow_auto_for(const std::chrono::duration<Rep, Period> &timeout)
+    {
+        T *obj = borrow_for(timeout);
+        if (!obj)
+            return PooledObject<T>();
+        return PooledObject<T>(obj, [this](T *p) { return_object(p); });
+    }
+
+    // 返回 shared_ptr 包装器
+    std::shared_ptr<T> borrow_shared()
+    {
+        T *obj = borrow();
+        if (!obj)
+            return nullptr;
+        return std::shared_ptr<T>(obj, [this](T *p) { return_object(p); });
+    }
+
+    // ========================================================================
+    // 归还接口
+    // ========================================================================
+
+    // 归还到当前线程所在分片
+    bool return_object(T *obj)
+    {
+        if (obj == nullptr)
+            return false;
+
+        bool ok = m_shards[current_shard()]->return_object(obj);
+        m_borrowed_count--;
+
+        // 对象或预算已释放，唤醒跨分片等待者
+        if (m_waiters.load(std::memory_order_acquire) > 0)
+        {
+            std::lock_guard<std::mutex> lock(m_wait_mutex);
+            m_wait_cv.notify_one();
+        }
+        return ok;
+    }
+
+    // ========================================================================
+    // 池管理
+    // ========================================================================
+
+    void shrink_to_fit()
+    {
+        for (auto &shard : m_shards)
+            shard->shrink_to_fit();
+    }
+
+    size_t reap_idle_objects()
+    {
+        size_t reaped = 0;
+        for (auto &shard : m_shards)
+            reaped += shard->reap_idle_objects();
+        return reaped;
+    }
+
+    // ========================================================================
+    // 统计信息
+    // ========================================================================
+
+    [[nodiscard]] size_t shard_count() const { return m_shards.size(); }
+
+    [[nodiscard]] size_t borrowed() const { return m_borrowed_count.load(); }
+
+    [[nodiscard]] size_t created() const { return m_global_created.load(); }
+
+    [[nodiscard]] size_t available() const
+    {
+        size_t total = 0;
+        for (const auto &shard : m_shards)
+            total += shard->available();
+        return total;
+    }
+
+    /// 汇总各分片统计（借出数、峰值与等待数取分片池自身的计数）
+    [[nodiscard]] ObjectPoolStats get_stats() const
+    {
+        ObjectPoolStats stats;
+        double idle_weighted = 0.0;
+        size_t idle_hits = 0;
+
+        for (const auto &shard : m_shards)
+        {
+            ObjectPoolStats s = shard->get_stats();
+            stats.available += s.available;
+            stats.total_borrows += s.total_borrows;
+            stats.total_returns += s.total_returns;
+            stats.total_destroyed += s.total_destroyed;
+            stats.total_creates_on_borrow += s.total_creates_on_borrow;
+            stats.total_create_failures += s.total_create_failures;
+            stats.total_prewarmed += s.total_prewarmed;
+            stats.total_adaptive_shrunk += s.total_adaptive_shrunk;
+            stats.adaptive_target_idle += s.adaptive_target_idle;
+
+            size_t hits = s.total_borrows - s.total_creates_on_borrow;
+            idle_weighted += s.avg_idle_time_ms * static_cast<double>(hits);
+            idle_hits += hits;
+        }
+
+        stats.created = m_global_created.load();
+        stats.borrowed = m_borrowed_count.load();
+        stats.peak_borrowed = m_peak_borrowed.load();
+        stats.total_timeouts = m_total_timeouts.load();
+        stats.current_waiters = m_waiters.load();
+        stats.peak_waiters = m_peak_waiters.load();
+        stats.total_steals = m_total_steals.load();
+        stats.hit_rate = stats.total_borrows > 0
+            ? static_cast<double>(stats.total_borrows - stats.total_creates_on_borrow) / stats.total_borrows
+            : 0.0;
+        stats.avg_idle_time_ms = idle_hits > 0 ? idle_weighted / idle_hits : 0.0;
+
+        size_t wait_samples = m_wait_sample_count.load();
+        stats.avg_wait_time_ms = wait_samples > 0
+            ? static_cast<double>(m_total_wait_time_us.load()) / 1000.0 / wait_samples
+            : 0.0;
+
+        return stats;
+    }
+
+private:
+    // 把 total 均分到 n 份，余数分给前面的分片
+    static size_t split(size_t total, size_t n, size_t i)
+    {
+        return total / n + (i < total % n ? 1 : 0);
+    }
+
+    // ------------------------------------------------------------------------
+    // 后台维护线程（空闲回收 + 各分片自适应采样）
+    // ------------------------------------------------------------------------
+
+    /// interval 为 0 表示不执行对应任务
+    void start_maintenance_thread(std::chrono::milliseconds cleanup_interval,
+                                  std::chrono::milliseconds sample_interval)
+    {
+        m_maintenance_running = true;
+        m_maintenance_thread = std::thread([this, cleanup_interval, sample_interval]() {
+            using clock = std::chrono::steady_clock;
+            const bool cleanup = cleanup_interval > std::chrono::milliseconds::zero();
+            const bool sample = sample_interval > std::chrono::milliseconds::zero();
+            auto next_cleanup = clock::now() + cleanup_interval;
+            auto next_sample = clock::now() + sample_interval;
+
+            std::unique_lock<std::mutex> lock(m_maintenance_mutex);
+            while (m_maintenance_running)
+            {
+                auto deadline = !cleanup ? next_sample
+                              : !sample  ? next_cleanup
+                                         : std::min(next_cleanup, next_sample);
+                m_maintenance_cv.wait_until(lock, deadline, [this] { return !m_maintenance_running; });
+                if (!m_maintenance_running)
+                    break;
+
+                lock.unlock();
+                auto now = clock::now();
+                if (sample && now >= next_sample)
+                {
+                    for (size_t i = 0; i < m_shards.size(); ++i)
+                        m_shards[i]->adaptive_tick(m_adaptive_states[i]);
+                    next_sample = now + sample_interval;
+                }
+                if (cleanup && now >= next_cleanup)
+                {
+                    reap_idle_objects();
+                    next_cleanup = now + cleanup_interval;
+                }
+                lock.lock();
+            }
+        });
+    }
+
+    void stop_maintenance_thread()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_maintenance_mutex);
+            m_maintenance_running = false;
+        }
+        m_maintenance_cv.notify_all();
+        if (m_maintenance_thread.joinable())
+        {
+            m_maintenance_thread.join();
+        }
+    }
+
+    // ------------------------------------------------------------------------
+    // 分片选择
+    // ------------------------------------------------------------------------
+
+    size_t current_shard() const
+    {
+        size_t n = m_shards.size();
+        if (n == 1)
+            return 0;
+
+#if defined(__linux__)
+        if (m_select == ShardSelect::cpu)
+        {
+            int cpu = sched_getcpu();
+            if (cpu >= 0)
+                return static_cast<size_t>(cpu) % n;
+        }
+#endif
+        thread_local size_t tid_hash = std::hash<std::thread::id>()(std::this_thread::get_id());
+        return tid_hash % n;
+    }
+
+    // ------------------------------------------------------------------------
+    // 全局预算（无锁计数）
+    // ------------------------------------------------------------------------
+
+    bool acquire_budget()
+    {
+        if (m_max_size == 0)
+        {
+            m_global_created.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        size_t current = m_global_created.load(std::memory_order_relaxed);
+        while (current < m_max_size)
+        {
+            if (m_global_created.compare_exchange_weak(current, current + 1,
+                    std::memory_order_acq_rel, std::memory_order_relaxed))
+                return true;
+        }
+        return false;
+    }
+
+    void release_budget()
+    {
+        m_global_created.fetch_sub(1, std::memory_order_acq_rel);
+    }
+
+    bool has_budget() const
+    {
+        return m_max_size == 0 || m_global_created.load(std::memory_order_relaxed) < m_max_size;
+    }
+
+    // ------------------------------------------------------------------------
+    // 借用实现
+    // ------------------------------------------------------------------------
+
+    T *try_acquire(size_t home)
+    {
+        if (auto obj = m_shards[home]->try_take_idle())
+            return *obj;
+
+        // 由近及远窃取相邻分片的空闲对象
+        size_t n = m_shards.size();
+        for (size_t i = 1; i < n; ++i)
+        {
+            if (auto obj = m_shards[(home + i) % n]->try_take_idle())
+            {
+                if (m_enable_stats)
+                    m_total_steals++;
+                return *obj;
+            }
+        }
+
+        // 全部为空，在本分片新建（预先判断预算，避免计入创建失败）
+        if (has_budget())
+        {
+            if (auto obj = m_shards[home]->try_borrow())
+                return *obj;
+        }
+        return nullptr;
+    }
+
+    T *borrow_impl(std::chrono::milliseconds timeout, bool use_timeout)
+    {
+        auto start = tracks_demand() ? std::chrono::steady_clock::now()
+                                     : std::chrono::steady_clock::time_point();
+
+        // 等待数与等待时间同时记到发起借用的分片，供该分片的控制器采样
+        ObjectPool<T> &home = *m_shards[current_shard()];
+
+        if (T *obj = try_acquire(current_shard()))
+        {
+            on_borrowed();
+            record_wait_time(start);
+            home.record_wait_time(start);
+            return obj;
+        }
+
+        std::unique_lock<std::mutex> lock(m_wait_mutex);
+        if (m_max_waiters > 0 && m_waiters.load() >= m_max_waiters)
+        {
+            if (m_enable_stats)
+                m_total_timeouts++;
+            return nullptr;
+        }
+
+        increment_waiters();
+        home.increment_waiters();
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        T *obj = nullptr;
+        while (true)
+        {
+            // 持有 m_wait_mutex 时重试，归还方通知前须获取该锁，不会丢失唤醒
+            obj = try_acquire(current_shard());
+            if (obj)
+                break;
+
+            if (use_timeout && timeout > std::chrono::milliseconds::zero())
+            {
+                if (m_wait_cv.wait_until(lock, deadline) == std::cv_status::timeout)
+                {
+                    obj = try_acquire(current_shard());
+                    break;
+                }
+            }
+            else
+            {
+                m_wait_cv.wait(lock);
+            }
+        }
+        m_waiters--;
+        home.decrement_waiters();
+        lock.unlock();
+
+        if (!obj)
+        {
+            if (m_enable_stats)
+                m_total_timeouts++;
+            return nullptr;
+        }
+
+        on_borrowed();
+        record_wait_time(start);
+        home.record_wait_time(start);
+        return obj;
+    }
+
+    bool tracks_demand() const noexcept
+    {
+        return m_enable_stats || m_adaptive_enabled;
+    }
+
+    void on_borrowed()
+    {
+        size_t current = m_borrowed_count.fetch_add(1) + 1;
+        if (!m_enable_stats)
+            return;
+
+        size_t peak = m_peak_borrowed.load();
+        while (current > peak && !m_peak_borrowed.compare_exchange_weak(peak, current)) {}
+    }
+
+    void increment_waiters()
+    {
+        size_t current = m_waiters.fetch_add(1) + 1;
+        if (!m_enable_stats)
+            return;
+
+        size_t peak = m_peak_waiters.load();
+        while (current > peak && !m_peak_waiters.compare_exchange_weak(peak, current)) {}
+    }
+
+    void record_wait_time(std::chrono::steady_clock::time_point start)
+    {
+        if (!m_enable_stats)
+            return;
+
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start);
+        m_total_wait_time_us += static_cast<uint64_t>(elapsed.count());
+        m_wait_sample_count++;
+    }
+
+private:
+    // 配置
+    std::function<void(T *)> m_deleter;
+    size_t m_max_size;
+    size_t m_max_waiters;
+    bool m_enable_stats;
+    bool m_adaptive_enabled;
+    std::function<void(size_t)> m_leak_callback;
+    ShardSelect m_select;
+
+    // 分片
+    std::vector<std::unique_ptr<ObjectPool<T>>> m_shards;
+
+    // 全局预算与统计
+    std::atomic<size_t> m_global_created{0};
+    std::atomic<size_t> m_borrowed_count{0};
+    std::atomic<size_t> m_peak_borrowed{0};
+    std::atomic<size_t> m_total_timeouts{0};
+    std::atomic<size_t> m_total_steals{0};
+    std::atomic<uint64_t> m_total_wait_time_us{0};
+    std::atomic<size_t> m_wait_sample_count{0};
+
+    // 跨分片等待
+    std::atomic<size_t> m_waiters{0};
+    std::atomic<size_t> m_peak_waiters{0};
+    std::mutex m_wait_mutex;
+    std::condition_variable m_wait_cv;
+
+    // 后台维护（各分片的控制器采样状态仅由维护线程访问）
+    std::vector<typename ObjectPool<T>::AdaptiveState> m_adaptive_states;
+    bool m_maintenance_running = false;
+    std::mutex m_maintenance_mutex;
+    std::condition_variable m_maintenance_cv;
+    std::thread m_maintenance_thread;
+};
+
+// ============================================================================
+// Slab 原地存储对象池
+// ============================================================================
+
+/// slab 池配置：对象在 slab 内原地构造，不使用 factory/deleter
+template <typename T>
+struct SlabObjectPoolConfig
+{
+    /// 原地构造函数：在给定内存上构造对象（默认调用 T 的默认构造）
+    std::function<T *(void *)> constructor = [](void *p) { return new (p) T(); };
+
+    /// 重置函数：对象归还时调用，恢复初始状态
+    std::function<void(T *)> resetter;
+
+    /// 验证函数：归还及健康检查时验证对象是否仍然有效
+    std::function<bool(T *)> validator;
+
+    /// 初始池大小
+    size_t initial_size = 10;
+
+    /// 最大池大小（0 = 无限制）
+    size_t max_size = 0;
+
+    /// 最大空闲时间（0 = 永不过期）
+    std::chrono::milliseconds max_idle_time = std::chrono::milliseconds(0);
+
+    /// 是否启用统计信息
+    bool enable_stats = true;
+
+    /// 泄漏检测回调（析构时如有未归还对象则调用）
+    std::function<void(size_t)> leak_callback = nullptr;
+};
+
+/// 对象按 SlabObjects 个一组在连续 slab 中原地构造，slab 内存取自 FixedMemoryPool；
+/// 槽位按 slab 下标跟踪，健康检查与空闲回收均为线性扫描，适合解析状态、缓冲区等小对象
+template <typename T, size_t SlabObjects = 64>
+class SlabObjectPool
+{
+public:
+    static_assert(SlabObjects > 0, "SlabObjects must be positive");
+    static_assert(alignof(T) <= alignof(std::max_align_t),
+                  "T alignment requirement not satisfied");
+
+    using Config = SlabObjectPoolConfig<T>;
+
+    // ========================================================================
+    // 构造与析构
+    // ========================================================================
+
+    explicit SlabObjectPool(const Config &cfg)
+        : m_constructor(cfg.constructor)
+        , m_resetter(cfg.resetter)
+        , m_validator(cfg.validator)
+        , m_max_size(cfg.max_size)
+        , m_max_idle_time(cfg.max_idle_time)
+        , m_enable_stats(cfg.enable_stats)
+        , m_leak_callback(cfg.leak_callback)
+        , m_memory(std::make_unique<FixedMemoryPool<kSlabBytes>>(slab_memory_config()))
+    {
+        if (!m_constructor)
+        {
+            throw std::invalid_argument("SlabObjectPool: constructor function is required");
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (size_t i = 0; i < cfg.initial_size; ++i)
+        {
+            size_t idx = create_slot_impl();
+            if (idx == npos)
+                break;
+            m_idle.push_back(idx);
+        }
+    }
+
+    ~SlabObjectPool()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        size_t leaked = 0;
+        for (size_t slab = 0; slab < m_slabs.size(); ++slab)
+        {
+            if (!m_slabs[slab])
+                continue;
+
+            bool in_use = false;
+            for (size_t idx = slab * SlabObjects; idx < (slab + 1) * SlabObjects; ++idx)
+            {
+                if (m_slots[idx].state == SlotState::borrowed)
+                {
+                    leaked++;
+                    in_use = true;
+                }
+                else if (m_slots[idx].state == SlotState::idle)
+                {
+                    slot_ptr(idx)->~T();
+                }
+            }
+            if (!in_use)
+                m_memory->deallocate(m_slabs[slab]);
+        }
+
+        // 与 ObjectPool 一致，不回收借出对象：放弃底层内存池，使含借出槽位的 slab 保持有效
+        //（析构后这些对象仍可访问，但不得再归还）
+        if (leaked > 0)
+            (void)m_memory.release();
+
+        if (leaked > 0 && m_leak_callback)
+        {
+            m_leak_callback(leaked);
+        }
+    }
+
+    // 槽位地址即对象地址，禁止拷贝与移动
+    SlabObjectPool(const SlabObjectPool &) = delete;
+    SlabObjectPool &operator=(const SlabObjectPool &) = delete;
+
+    // ========================================================================
+    // 借用接口
+    // ========================================================================
+
+    // 阻塞借用（无限等待）
+    T *borrow()
+    {
+        return borrow_impl(std::chrono::milliseconds::zero(), false);
+    }
+
+    // 带超时的借用
+    template <typename Rep, typename Period>
+    T *borrow_for(const std::chrono::duration<Rep, Period> &timeout)
+    {
+        return borrow_impl(
+            std::chrono::duration_cast<std::chrono::milliseconds>(timeout),
+            true);
+    }
+
+    // 非阻塞借用（立即返回）
+    std::optional<T *> try_borrow()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        T *obj = acquire_impl();
+        if (!obj)
+            return std::nullopt;
+        return obj;
+    }
+
+    // 自动归还的包装器（阻塞）
+    PooledObject<T> borrow_auto()
+    {
+        T *obj = borrow();
+        return PooledObject<T>(obj, [this](T *p) { return_object(p); });
+    }
+
+    // 自动归还的包装器（带超时）
+    template <typename Rep, typename Period>
+    PooledObject<T> borrow_auto_for(const std::chrono::duration<Rep, Period> &timeout)
+    {
+        T *obj = borrow_for(timeout);
+        if (!obj)
+            return PooledObject<T>();
+        return PooledObject<T>(obj, [this](T *p) { return_object(p); });
+    }
+
+    // ========================================================================
+    // 归还接口
+    // ========================================================================
+
+    bool return_object(T *obj)
+    {
+        if (obj == nullptr)
+            return false;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        size_t idx = index_of(obj);
+        if (idx == npos || m_slots[idx].state != SlotState::borrowed)
+        {
+            POOL_ASSERT(false, "Object not borrowed from this pool");
+            return false;
+        }
+
+        // 与 ObjectPool 一致：验证失败视为正常归还（对象被销毁），仅重置失败返回 false
+        bool keep = run_validator(obj);
+        bool accepted = true;
+        if (keep && m_resetter)
+        {
+            try
+            {
+                m_resetter(obj);
+            }
+            catch (...)
+            {
+                keep = false;
+                accepted = false;
+            }
+        }
+
+        m_borrowed_count--;
+        m_total_returns++;
+
+        if (keep)
+        {
+            m_slots[idx].state = SlotState::idle;
+            m_slots[idx].last_used = std::chrono::steady_clock::now();
+            m_idle.push_back(idx);
+        }
+        else
+        {
+            destroy_slot_impl(idx);
+            release_empty_slabs_impl();
+        }
+
+        m_cv.notify_one();
+        return accepted;
+    }
+
+    // ========================================================================
+    // 池管理
+    // ========================================================================
+
+    /// 线性扫描所有空闲槽位，销毁验证失败的对象，返回销毁数
+    size_t health_check()
+    {
+        if (!m_validator)
+            return 0;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return sweep_impl([this](size_t idx) { return !run_validator(slot_ptr(idx)); });
+    }
+
+    /// 线性扫描回收空闲超时的对象
+    size_t reap_idle_objects()
+    {
+        if (m_max_idle_time == std::chrono::milliseconds::zero())
+            return 0;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto now = std::chrono::steady_clock::now();
+        return sweep_impl([this, now](size_t idx) {
+            return now - m_slots[idx].last_used >= m_max_idle_time;
+        });
+    }
+
+    /// 销毁所有空闲对象并归还空 slab
+    void shrink_to_fit()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        sweep_impl([](size_t) { return true; });
+    }
+
+    // ========================================================================
+    // 统计信息
+    // ========================================================================
+
+    [[nodiscard]] size_t available() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_idle.size();
+    }
+
+    [[nodiscard]] size_t borrowed() const { return m_borrowed_count.load(); }
+
+    [[nodiscard]] size_t created() const { return m_created_count.load(); }
+
+    [[nodiscard]] size_t slab_count() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_slabs.size() - m_empty_slabs.size();
+    }
+
+    [[nodiscard]] ObjectPoolStats get_stats() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        ObjectPoolStats stats;
+        stats.created = m_created_count.load();
+        stats.borrowed = m_borrowed_count.load();
+        stats.available = m_idle.size();
+        stats.peak_borrowed = m_peak_borrowed.load();
+        stats.total_borrows = m_total_borrows.load();
+        stats.total_returns = m_total_returns.load();
+        stats.total_destroyed = m_total_destroyed.load();
+        stats.total_timeouts = m_total_timeouts.load();
+        stats.total_creates_on_borrow = m_total_creates_on_borrow.load();
+        stats.total_create_failures = m_total_create_failures.load();
+        stats.current_waiters = m_current_waiters;
+        stats.hit_rate = stats.total_borrows > 0
+            ? static_cast<double>(stats.total_borrows - stats.total_creates_on_borrow) / stats.total_borrows
+            : 0.0;
+        return stats;
+    }
+
+private:
+    enum class SlotState : uint8_t
+    {
+        free,       // 未构造
+        idle,       // 已构造，可借用
+        borrowed    // 已借出
+    };
+
+    struct SlotMeta
+    {
+        SlotState state = SlotState::free;
+        std::chrono::steady_clock::time_point last_used;
+    };
+
+    static constexpr size_t npos = static_cast<size_t>(-1);
+    static constexpr size_t kSlabBytes = std::max(sizeof(T) * SlabObjects, sizeof(void *));
+
+    static MemoryPoolConfig slab_memory_config()
+    {
+        // 每个 chunk 即一个 slab，完全空闲的 slab 可由 FixedMemoryPool 收缩释放；
+        // 加锁由对象池负责
+        MemoryPoolConfig cfg;
+        cfg.block_size = kSlabBytes;
+        cfg.blocks_per_chunk = 1;
+        cfg.shrink_threshold_chunks = 2;
+        cfg.use_lock = false;
+        return cfg;
+    }
+
+    T *slot_ptr(size_t idx) const
+    {
+        return static_cast<T *>(m_slabs[idx / SlabObjects]) + idx % SlabObjects;
+    }
+
+    // 通过按地址排序的 slab 索引二分查找槽位下标
+    size_t index_of(const T *obj) const
+    {
+        auto it = std::upper_bound(m_slab_index.begin(), m_slab_index.end(), obj,
+                                   [](const T *p, const std::pair<const T *, size_t> &e) {
+                                       return p < e.first;
+                                   });
+        if (it == m_slab_index.begin())
+            return npos;
+        --it;
+
+        auto offset = static_cast<size_t>(obj - it->first);
+        if (offset >= SlabObjects)
+            return npos;
+        return it->second * SlabObjects + offset;
+    }
+
+    bool run_validator(T *obj)
+    {
+        if (!m_validator)
+            return true;
+        try
+        {
+            return m_validator(obj);
+        }
+        catch (...)
+        {
+            return false;
+        }
+    }
+
+    // ------------------------------------------------------------------------
+    // 槽位管理
+    // ------------------------------------------------------------------------
+
+    bool add_slab_impl()
+    {
+        void *mem = m_memory->allocate();
+        if (!mem)
+            return false;
+
+        size_t slab;
+        if (!m_empty_slabs.empty())
+        {
+            slab = m_empty_slabs.back();
+            m_empty_slabs.pop_back();
+            m_slabs[slab] = mem;
+        }
+        else
+        {
+            slab = m_slabs.size();
+            m_slabs.push_back(mem);
+            m_slots.resize(m_slots.size() + SlabObjects);
+        }
+
+        auto entry = std::make_pair(static_cast<const T *>(mem), slab);
+        m_slab_index.insert(std::upper_bound(m_slab_index.begin(), m_slab_index.end(), entry), entry);
+
+        // 逆序入栈，使低地址槽位先被使用
+        for (size_t i = SlabObjects; i > 0; --i)
+        {
+            m_free_slots.push_back(slab * SlabObjects + i - 1);
+        }
+        return true;
+    }
+
+    size_t create_slot_impl()
+    {
+        if (m_max_size > 0 && m_created_count >= m_max_size)
+            return npos;
+
+        if (m_free_slots.empty() && !add_slab_impl())
+        {
+            if (m_enable_stats)
+                m_total_create_failures++;
+            return npos;
+        }
+
+        size_t idx = m_free_slots.back();
+        try
+        {
+            m_constructor(slot_ptr(idx));
+        }
+        catch (...)
+        {
+            if (m_enable_stats)
+                m_total_create_failures++;
+            release_empty_slabs_impl();
+            return npos;
+        }
+
+        m_free_slots.pop_back();
+        m_slots[idx].state = SlotState::idle;
+        m_slots[idx].last_used = std::chrono::steady_clock::now();
+        m_created_count++;
+        return idx;
+    }
+
+    void destroy_slot_impl(size_t idx)
+    {
+        slot_ptr(idx)->~T();
+        m_slots[idx].state = SlotState::free;
+        m_free_slots.push_back(idx);
+        m_created_count--;
+        m_total_destroyed++;
+    }
+
+    // 归还完全空闲的 slab，并重建空闲槽位栈（线性扫描）
+    void release_empty_slabs_impl()
+    {
+        size_t live_slabs = m_slabs.size() - m_empty_slabs.size();
+        if (m_free_slots.size() < SlabObjects || live_slabs <= 1)
+            return;
+
+        bool released = false;
+        for (size_t slab = 0; slab < m_slabs.size() && live_slabs > 1; ++slab)
+        {
+            if (!m_slabs[slab])
+                continue;
+
+            size_t base = slab * SlabObjects;
+            bool empty = true;
+            for (size_t i = 0; i < SlabObjects && empty; ++i)
+            {
+                empty = m_slots[base + i].state == SlotState::free;
+            }
+            if (!empty)
+                continue;
+
+            const T *addr = static_cast<const T *>(m_slabs[slab]);
+            m_slab_index.erase(std::find_if(m_slab_index.begin(), m_slab_index.end(),
+                                            [addr](const auto &e) { return e.first == addr; }));
+            m_memory->deallocate(m_slabs[slab]);
+            m_slabs[slab] = nullptr;
+            m_empty_slabs.push_back(slab);
+            live_slabs--;
+            released = true;
+        }
+
+        if (!released)
+            return;
+
+        m_free_slots.clear();
+        for (size_t idx = m_slots.size(); idx > 0; --idx)
+        {
+            if (m_slabs[(idx - 1) / SlabObjects] && m_slots[idx - 1].state == SlotState::free)
+                m_free_slots.push_back(idx - 1);
+        }
+    }
+
+    // 线性扫描空闲槽位，销毁满足条件的对象，并按地址顺序重建空闲栈
+    template <typename Pred>
+    size_t sweep_impl(Pred &&should_destroy)
+    {
+        size_t destroyed = 0;
+        m_idle.clear();
+        for (size_t idx = m_slots.size(); idx > 0; --idx)
+        {
+            size_t i = idx - 1;
+            if (m_slots[i].state != SlotState::idle)
+                continue;
+
+            if (should_destroy(i))
+            {
+                destroy_slot_impl(i);
+                destroyed++;
+            }
+            else
+            {
+                m_idle.push_back(i);
+            }
+        }
+
+        if (destroyed > 0)
+            release_empty_slabs_impl();
+        return destroyed;
+    }
+
+    // ------------------------------------------------------------------------
+    // 借用实现
+    // ------------------------------------------------------------------------
+
+    T *acquire_impl()
+    {
+        size_t idx = npos;
+        bool created = false;
+        if (!m_idle.empty())
+        {
+            idx = m_idle.back();
+            m_idle.pop_back();
+        }
+        else
+        {
+            idx = create_slot_impl();
+            created = true;
+        }
+
+        if (idx == npos)
+            return nullptr;
+
+        m_slots[idx].state = SlotState::borrowed;
+        m_total_borrows++;
+        if (created && m_enable_stats)
+            m_total_creates_on_borrow++;
+
+        size_t current = ++m_borrowed_count;
+        if (m_enable_stats && current > m_peak_borrowed)
+            m_peak_borrowed = current;
+
+        return slot_ptr(idx);
+    }
+
+    T *borrow_impl(std::chrono::milliseconds timeout, bool use_timeout)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        auto can_acquire = [this] {
+            return !m_idle.empty() || m_max_size == 0 || m_created_count < m_max_size;
+        };
+
+        m_current_waiters++;
+        bool ready = true;
+        if (use_timeout && timeout > std::chrono::milliseconds::zero())
+        {
+            ready = m_cv.wait_for(lock, timeout, can_acquire);
+        }
+        else
+        {
+            m_cv.wait(lock, can_acquire);
+        }
+        m_current_waiters--;
+
+        if (!ready)
+        {
+            if (m_enable_stats)
+                m_total_timeouts++;
+            return nullptr;
+        }
+
+        return acquire_impl();
+    }
+
+private:
+    // 配置
+    std::function<T *(void *)> m_constructor;
+    std::function<void(T *)> m_resetter;
+    std::function<bool(T *)> m_validator;
+    size_t m_max_size;
+    std::chrono::milliseconds m_max_idle_time;
+    bool m_enable_stats;
+    std::function<void(size_t)> m_leak_callback;
+
+    // slab 存储（均由 m_mutex 保护）
+    std::unique_ptr<FixedMemoryPool<kSlabBytes>> m_memory;
+    std::vector<void *> m_slabs;                            // slab 下标 -> 内存（已释放为 nullptr）
+    std::vector<size_t> m_empty_slabs;                      // 可复用的 slab 下标
+    std::vector<std::pair<const T *, size_t>> m_slab_index; // 按地址排序的 (内存, slab 下标)
+    std::vector<SlotMeta> m_slots;                          // 槽位下标 = slab * SlabObjects + 偏移
+    std::vector<size_t> m_idle;                             // 空闲对象槽位栈
+    std::vector<size_t> m_free_slots;                       // 未构造槽位栈
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+
+    // 统计
+    size_t m_current_waiters = 0;
+    std::atomic<size_t> m_created_count{0};
+    std::atomic<size_t> m_borrowed_count{0};
+    std::atomic<size_t> m_peak_borrowed{0};
+    std::atomic<size_t> m_total_borrows{0};
+    std::atomic<size_t> m_total_returns{0};
+    std::atomic<size_t> m_total_destroyed{0};
+    std::atomic<size_t> m_total_timeouts{0};
+    std::atomic<size_t> m_total_creates_on_borrow{0};
+    std::atomic<size_t> m_total_create_failures{0};
+};
+
+// ============================================================================
+// 线程本地对象池
+// ============================================================================
+
+template <typename T>
+class ThreadLocalObjectPool
+{
+public:
+    explicit ThreadLocalObjectPool(size_t local_size = 8)
+        : m_local_size(local_size) {}
+
+    ~ThreadLocalObjectPool()
+    {
+        clear();
+    }
 
     T *borrow()
     {
@@ -1184,13 +2791,51 @@ public:
         size_t initial_connections = 5;
         size_t max_waiters = 100;
         bool enable_auto_cleanup = true;
-        bool enable_retry = true;
-        size_t max_retries = 3;
+        bool enable_retry = true;           // 连接数不足 initial_connections 时后台重连
+        size_t max_retries = 3;             // 连续失败后的最大重连次数，用尽后暂停后台重连，
+                                            // 直到借用路径建连成功（服务恢复）后再继续
+        size_t max_backoff_doublings = 6;   // 退避延迟的最大翻倍次数（仍受 retry_max_delay 限制）
+        std::chrono::milliseconds retry_base_delay{100};    // 重连退避基准延迟
+        std::chrono::milliseconds retry_max_delay{5000};    // 重连退避延迟上限
+        size_t connect_parallelism = 4;     // 初始连接的并行建连线程数
+        std::chrono::milliseconds health_check_interval{30000}; // 后台健康检查周期（0 = 关闭）
+        size_t health_check_batch = 8;      // 每批验证的空闲连接数
+        ObjectPoolAdaptiveConfig adaptive;  // 自适应预热/收缩，流量爬升时避免借用时建连
     };
 
     explicit ConnectionPool(const ConnectionConfig &cfg)
         : Base(create_config(cfg))
-        , m_config(cfg) {}
+        , m_config(cfg)
+    {
+        connect_initial();
+        start_maintenance_thread();
+    }
+
+    ~ConnectionPool()
+    {
+        stop_maintenance_thread();
+    }
+
+    // 移动语义：维护线程持有 other 的 this，需先停止再在新对象上按配置重启
+    ConnectionPool(ConnectionPool &&other) noexcept
+        : Base(std::move(stopped(other)))
+        , m_config(other.m_config)
+    {
+        start_maintenance_thread();
+    }
+
+    ConnectionPool &operator=(ConnectionPool &&other) noexcept
+    {
+        if (this != &other)
+        {
+            stop_maintenance_thread();
+            other.stop_maintenance_thread();
+            Base::operator=(std::move(other));
+            m_config = other.m_config;
+            start_maintenance_thread();
+        }
+        return *this;
+    }
 
     // 健康检查
     bool health_check()
@@ -1209,39 +2854,44 @@ public:
         }
     }
 
+    /// 立即分批验证全部空闲连接，返回断开的连接数
+    size_t sweep_idle()
+    {
+        size_t batch = std::max<size_t>(1, m_config.health_check_batch);
+        size_t remaining = this->available();
+        size_t removed = 0;
+        while (remaining > 0)
+        {
+            size_t n = std::min(batch, remaining);
+            removed += this->validate_idle(n);
+            remaining -= n;
+        }
+        return removed;
+    }
+
     const ConnectionConfig &config() const { return m_config; }
 
 private:
+    // 移动构造时在基类移动之前停止源对象的维护线程
+    static ConnectionPool &stopped(ConnectionPool &pool) noexcept
+    {
+        pool.stop_maintenance_thread();
+        return pool;
+    }
+
     static typename Base::Config create_config(const ConnectionConfig &cfg)
     {
         typename Base::Config config;
         
+        // 借用路径只尝试一次，失败后的重试交给后台线程，不在借用方线程中睡眠
         config.factory = [cfg]() -> Connection * {
             std::unique_ptr<Connection> conn(new Connection());
-            
-            for (size_t retry = 0; retry <= (cfg.enable_retry ? cfg.max_retries : 0); ++retry)
+            if (conn->connect(cfg.host, cfg.port, 
+                              cfg.username, cfg.password, 
+                              cfg.database, cfg.connect_timeout))
             {
-                try
-                {
-                    if (conn->connect(cfg.host, cfg.port, 
-                                      cfg.username, cfg.password, 
-                                      cfg.database, cfg.connect_timeout))
-                    {
-                        return conn.release();
-                    }
-                }
-                catch (...)
-                {
-                    if (retry == cfg.max_retries)
-                        throw;
-                }
-                
-                if (retry < cfg.max_retries)
-                {
-                    std::this_thread::sleep_for(std::chrono::milliseconds(100 * (retry + 1)));
-                }
+                return conn.release();
             }
-            
             return nullptr;
         };
         
@@ -1281,11 +2931,13 @@ private:
             }
         };
         
-        config.initial_size = cfg.initial_connections;
+        // 初始连接在构造函数中并行建立
+        config.initial_size = 0;
         config.max_size = cfg.max_connections;
         config.max_waiters = cfg.max_waiters;
         config.max_idle_time = cfg.idle_timeout;
         config.enable_auto_cleanup = cfg.enable_auto_cleanup;
+        config.adaptive = cfg.adaptive;
         
         config.leak_callback = [](size_t leaked) {
             std::cerr << "WARNING: ConnectionPool destroyed with " 
@@ -1295,7 +2947,152 @@ private:
         return config;
     }
 
+    size_t target_connections() const
+    {
+        size_t target = m_config.initial_connections;
+        if (m_config.max_connections > 0)
+            target = std::min(target, m_config.max_connections);
+        return target;
+    }
+
+    // ------------------------------------------------------------------------
+    // 并行建立初始连接
+    // ------------------------------------------------------------------------
+
+    void connect_initial()
+    {
+        size_t target = target_connections();
+        if (target == 0)
+            return;
+
+        size_t workers = std::clamp<size_t>(m_config.connect_parallelism, 1, target);
+        std::atomic<size_t> next{0};
+        auto connect_worker = [this, &next, target]() {
+            while (next.fetch_add(1) < target)
+            {
+                try
+                {
+                    this->warm_up(1);
+                }
+                catch (...) {}
+            }
+        };
+
+        std::vector<std::thread> threads;
+        threads.reserve(workers - 1);
+        for (size_t i = 1; i < workers; ++i)
+        {
+            threads.emplace_back(connect_worker);
+        }
+        connect_worker();
+        for (auto &t : threads)
+        {
+            t.join();
+        }
+    }
+
+    // ------------------------------------------------------------------------
+    // 后台维护：分批健康检查 + 抖动退避重连
+    // ------------------------------------------------------------------------
+
+    std::chrono::milliseconds reconnect_delay(size_t attempt)
+    {
+        auto base = std::max<int64_t>(1, m_config.retry_base_delay.count());
+        size_t shift = std::min<size_t>({attempt, m_config.max_backoff_doublings, 30});
+        int64_t cap = std::min<int64_t>(m_config.retry_max_delay.count(), base << shift);
+        cap = std::max<int64_t>(cap, 1);
+
+        // equal jitter：在 [cap/2, cap] 内均匀取值，保留最小退避的同时错开多个池的重连
+        std::uniform_int_distribution<int64_t> dist(cap / 2, cap);
+        return std::chrono::milliseconds(dist(m_rng));
+    }
+
+    void start_maintenance_thread()
+    {
+        bool health_enabled = m_config.health_check_interval > std::chrono::milliseconds::zero();
+        if (!health_enabled && !m_config.enable_retry)
+            return;
+
+        m_maintenance_running = true;
+        m_maintenance_thread = std::thread([this, health_enabled]() {
+            using clock = std::chrono::steady_clock;
+
+            auto next_health = clock::now() + m_config.health_check_interval;
+            auto next_reconnect = clock::now();
+            size_t attempt = 0;
+            size_t last_created = this->created();  // 重试用尽后借用路径新建连接视为服务恢复
+
+            std::unique_lock<std::mutex> lock(m_maintenance_mutex);
+            while (m_maintenance_running)
+            {
+                auto now = clock::now();
+                size_t created = this->created();
+                if (attempt >= m_config.max_retries && created > last_created)
+                    attempt = 0;
+                last_created = created;
+                bool need_reconnect = m_config.enable_retry &&
+                                      attempt < m_config.max_retries &&
+                                      created < target_connections();
+                if (need_reconnect && now >= next_reconnect)
+                {
+                    lock.unlock();
+                    size_t missing = target_connections() - std::min(this->created(), target_connections());
+                    bool ok = false;
+                    try
+                    {
+                        ok = this->warm_up(missing);
+                    }
+                    catch (...) {}
+                    bool complete = this->created() >= target_connections();
+                    lock.lock();
+
+                    attempt = ok && complete ? 0 : attempt + 1;
+                    last_created = this->created();
+                    next_reconnect = clock::now() + (attempt > 0 ? reconnect_delay(attempt - 1)
+                                                                 : std::chrono::milliseconds::zero());
+                    continue;
+                }
+
+                if (health_enabled && now >= next_health)
+                {
+                    lock.unlock();
+                    sweep_idle();
+                    lock.lock();
+                    next_health = clock::now() + m_config.health_check_interval;
+                    continue;
+                }
+
+                auto wake = health_enabled ? next_health : now + std::chrono::seconds(1);
+                if (need_reconnect)
+                    wake = std::min(wake, next_reconnect);
+                else if (m_config.enable_retry && attempt >= m_config.max_retries)
+                    wake = std::min(wake, now + std::chrono::seconds(1));
+                m_maintenance_cv.wait_until(lock, wake, [this] { return !m_maintenance_running; });
+            }
+        });
+    }
+
+    void stop_maintenance_thread()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_maintenance_mutex);
+            m_maintenance_running = false;
+        }
+        m_maintenance_cv.notify_all();
+        if (m_maintenance_thread.joinable())
+        {
+            m_maintenance_thread.join();
+        }
+    }
+
     ConnectionConfig m_config;
+
+    // 后台维护
+    bool m_maintenance_running = false;
+    std::mutex m_maintenance_mutex;
+    std::condition_variable m_maintenance_cv;
+    std::thread m_maintenance_thread;
+    std::mt19937_64 m_rng{std::random_device{}()};
 };
 
 #endif // OBJECT_POOL_HPP
\ No newline at end of file
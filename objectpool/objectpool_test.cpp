@@ -0,0 +1,195 @@
+/***************************************************************
+Copyright (c) 2022-2030, shisan233@sszc.live.
+SPDX-License-Identifier: MIT
+File:        objectpool_test.cpp
+Version:     1.0
+Author:      cjx
+start date: 2026-10-18
+Description: ShardedObjectPool / SlabObjectPool 功能测试
+             覆盖分片池等待压力驱动的自适应扩容、slab 扩展下的借还与析构时的借出对象
+             编译运行：g++ -std=c++17 -O1 objectpool_test.cpp -o objectpool_test -pthread && ./objectpool_test
+Version history
+
+[序号]    |   [修改日期]  |   [修改者]   |   [修改内容]
+1            2026-10-18       cjx           create
+2            2026-10-18       cjx           SlabObjectPool 借还与析构测试
+
+*****************************************************************/
+
+#include "objectpool.hpp"
+
+#include <cstdio>
+#include <set>
+
+using clock_type = std::chrono::steady_clock;
+using std::chrono::milliseconds;
+
+// ============================================================================
+// 测试工具
+// ============================================================================
+
+static int g_failures = 0;
+
+#define CHECK(cond)                                                             \
+    do                                                                          \
+    {                                                                           \
+        if (!(cond))                                                            \
+        {                                                                       \
+            std::printf("  FAILED %s:%d: %s\n", __FILE__, __LINE__, #cond);     \
+            g_failures++;                                                       \
+        }                                                                       \
+    } while (0)
+
+template <typename Pred>
+static bool wait_until(Pred pred, milliseconds timeout = milliseconds(2000))
+{
+    auto deadline = clock_type::now() + timeout;
+    while (!pred())
+    {
+        if (clock_type::now() >= deadline)
+            return false;
+        std::this_thread::sleep_for(milliseconds(2));
+    }
+    return true;
+}
+
+// ============================================================================
+// ShardedObjectPool
+// ============================================================================
+
+static void test_sharded_wait_pressure()
+{
+    std::printf("sharded adaptive reacts to waiters\n");
+
+    ObjectPoolConfig<int> cfg;
+    cfg.factory = []() { return new int(0); };
+    cfg.initial_size = 2;
+    cfg.max_size = 2;
+    cfg.enable_stats = false;
+    cfg.adaptive.enabled = true;
+    cfg.adaptive.sample_interval = milliseconds(10);
+    cfg.adaptive.smoothing = 1.0;
+    cfg.adaptive.wait_threshold = milliseconds(1);
+
+    ShardedObjectPool<int> pool(cfg, 2, ShardSelect::thread);
+
+    // 占满全局预算，等控制器消化借出增长后目标回到 0
+    int *a = pool.borrow();
+    int *b = pool.borrow();
+    CHECK(a != nullptr && b != nullptr);
+    CHECK(wait_until([&] { return pool.get_stats().adaptive_target_idle == 0; }));
+    std::this_thread::sleep_for(milliseconds(30));
+    CHECK(pool.get_stats().adaptive_target_idle == 0);
+
+    // 阻塞的借用者使所在分片的控制器提高目标空闲数
+    int *waited = nullptr;
+    std::thread borrower([&] { waited = pool.borrow(); });
+    CHECK(wait_until([&] { return pool.get_stats().current_waiters == 1; }));
+    CHECK(wait_until([&] { return pool.get_stats().adaptive_target_idle >= 1; }));
+
+    pool.return_object(a);
+    borrower.join();
+    CHECK(waited != nullptr);
+    pool.return_object(waited);
+    pool.return_object(b);
+    CHECK(pool.borrowed() == 0);
+}
+
+// ============================================================================
+// SlabObjectPool
+// ============================================================================
+
+struct Tracked
+{
+    static std::atomic<int> alive;
+    int value = 0;
+
+    Tracked() { alive++; }
+    ~Tracked() { alive--; }
+};
+
+std::atomic<int> Tracked::alive{0};
+
+static void test_slab_growth()
+{
+    std::printf("slab borrow/return across slab growth\n");
+    Tracked::alive = 0;
+    {
+        SlabObjectPoolConfig<Tracked> cfg;
+        cfg.initial_size = 0;
+        cfg.resetter = [](Tracked *t) { t->value = 0; };
+        SlabObjectPool<Tracked, 4> pool(cfg);
+
+        // 10 个对象跨越 3 个 slab，地址互不相同
+        std::vector<Tracked *> objs;
+        for (int i = 0; i < 10; ++i)
+        {
+            Tracked *t = pool.borrow();
+            CHECK(t != nullptr);
+            t->value = i + 1;
+            objs.push_back(t);
+        }
+        CHECK(std::set<Tracked *>(objs.begin(), objs.end()).size() == 10);
+        CHECK(pool.slab_count() == 3);
+        CHECK(pool.borrowed() == 10);
+        CHECK(Tracked::alive == 10);
+
+        for (Tracked *t : objs)
+            CHECK(pool.return_object(t));
+        CHECK(pool.borrowed() == 0);
+        CHECK(pool.available() == 10);
+
+        // 再次借用复用已构造对象，且已被重置
+        Tracked *again = pool.borrow();
+        CHECK(again->value == 0);
+        CHECK(pool.created() == 10);
+        pool.return_object(again);
+
+        // 收缩后只保留一个 slab
+        pool.shrink_to_fit();
+        CHECK(pool.available() == 0);
+        CHECK(pool.slab_count() == 1);
+        CHECK(Tracked::alive == 0);
+    }
+    CHECK(Tracked::alive == 0);
+}
+
+static void test_slab_destroy_with_borrowed()
+{
+    std::printf("slab destroyed while objects are borrowed\n");
+    Tracked::alive = 0;
+
+    size_t reported = 0;
+    Tracked *held = nullptr;
+    {
+        SlabObjectPoolConfig<Tracked> cfg;
+        cfg.initial_size = 6;
+        cfg.leak_callback = [&reported](size_t n) { reported = n; };
+        SlabObjectPool<Tracked, 4> pool(cfg);
+
+        held = pool.borrow();
+        held->value = 42;
+    }
+
+    // 借出对象所在 slab 未被释放，对象仍然有效；空闲对象均已析构
+    CHECK(reported == 1);
+    CHECK(Tracked::alive == 1);
+    held->value++;
+    CHECK(held->value == 43);
+    held->~Tracked();
+}
+
+int main()
+{
+    test_sharded_wait_pressure();
+    test_slab_growth();
+    test_slab_destroy_with_borrowed();
+
+    if (g_failures > 0)
+    {
+        std::printf("%d check(s) failed\n", g_failures);
+        return 1;
+    }
+    std::printf("all passed\n");
+    return 0;
+}
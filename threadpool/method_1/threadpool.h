@@ -1,8 +1,8 @@
 /***************************************************************
 Copyright (c) 2022-2030, shisan233@sszc.live.
-SPDX-License-Identifier: MIT 
+SPDX-License-Identifier: MIT
 File:        threadpool.h
-Version:     1.0
+Version:     1.1
 Author:      cjx
 start date: 2024-12-28
 Description: 简单的线程池模板,提供基础的任务队列增加功能
@@ -11,80 +11,261 @@ Version history
 
 [序号]    |   [修改日期]  |   [修改者]   |   [修改内容]
 1            2024-12-28       cjx         create
+2            2026-10-18       cjx         去掉std::result_of；新增post/submit，任务存储不再经过std::function
 
 *****************************************************************/
 
 #ifndef THREADPOOL_H_
 #define THREADPOOL_H_
 
-#include <iostream>
+#include <cstddef>
 #include <vector>
-#include <queue>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
 #include <functional>
 #include <future>
+#include <new>
 #include <stdexcept>
+#include <type_traits>
+#include <utility>
 
 class ThreadPool
 {
+    // 调用结果类型（C++17起std::result_of已弃用，C++20移除）
+#if defined(__cpp_lib_is_invocable)
+    template <class F, class... Args>
+    using result_t = typename std::invoke_result<F, Args...>::type;
+#else
+    template <class F, class... Args>
+    using result_t = typename std::result_of<F(Args...)>::type;
+#endif
+
 public:
     explicit ThreadPool(size_t);
+    // 添加任务，返回future（future共享状态只分配一次）
+    template <class F, class... Args>
+    auto submit(F &&, Args &&...) -> std::future<result_t<F, Args...>>;
+    // 同submit，保留旧接口
     template <class F, class... Args>
-    auto enqueue(F &&, Args &&...) -> std::future<typename std::result_of<F(Args...)>::type>;
+    auto enqueue(F &&, Args &&...) -> std::future<result_t<F, Args...>>;
+    // 添加无需结果的任务，小型可调用对象不分配内存，任务抛出的异常被丢弃
+    template <class F, class... Args>
+    void post(F &&, Args &&...);
     ~ThreadPool();
 
 private:
+    // 仅支持移动的任务包装，小对象直接存放在内部缓冲区
+    class task
+    {
+    public:
+        task() noexcept : invoke(nullptr), manage(nullptr) {}
+
+        template <class F, class D = typename std::decay<F>::type,
+                  class = typename std::enable_if<!std::is_same<D, task>::value>::type>
+        task(F &&f)
+        {
+            construct<D>(std::forward<F>(f), std::integral_constant<bool, fits<D>::value>());
+        }
+
+        task(task &&other) noexcept : invoke(other.invoke), manage(other.manage)
+        {
+            if (manage)
+                manage(storage, other.storage);
+            other.invoke = nullptr;
+            other.manage = nullptr;
+        }
+
+        task &operator=(task &&other) noexcept
+        {
+            if (this != &other)
+            {
+                reset();
+                invoke = other.invoke;
+                manage = other.manage;
+                if (manage)
+                    manage(storage, other.storage);
+                other.invoke = nullptr;
+                other.manage = nullptr;
+            }
+            return *this;
+        }
+
+        task(const task &) = delete;
+        task &operator=(const task &) = delete;
+
+        ~task() { reset(); }
+
+        void operator()() { invoke(storage); }
+
+    private:
+        static constexpr size_t inline_size = 4 * sizeof(void *);
+
+        template <class D>
+        struct fits : std::integral_constant<bool, sizeof(D) <= inline_size &&
+                                                       alignof(D) <= alignof(std::max_align_t) &&
+                                                       std::is_nothrow_move_constructible<D>::value>
+        {
+        };
+
+        // manage(dst, src)：dst非空时把src移动到dst，随后销毁src
+        template <class D>
+        struct inline_ops
+        {
+            static void invoke(void *p) { (*static_cast<D *>(p))(); }
+            static void manage(void *dst, void *src) noexcept
+            {
+                D *from = static_cast<D *>(src);
+                if (dst)
+                    ::new (dst) D(std::move(*from));
+                from->~D();
+            }
+        };
+
+        template <class D>
+        struct heap_ops
+        {
+            static void invoke(void *p) { (**static_cast<D **>(p))(); }
+            static void manage(void *dst, void *src) noexcept
+            {
+                D **from = static_cast<D **>(src);
+                if (dst)
+                    *static_cast<D **>(dst) = *from;
+                else
+                    delete *from;
+            }
+        };
+
+        template <class D, class F>
+        void construct(F &&f, std::true_type)
+        {
+            ::new (static_cast<void *>(storage)) D(std::forward<F>(f));
+            invoke = &inline_ops<D>::invoke;
+            manage = &inline_ops<D>::manage;
+        }
+
+        template <class D, class F>
+        void construct(F &&f, std::false_type)
+        {
+            *reinterpret_cast<D **>(storage) = new D(std::forward<F>(f));
+            invoke = &heap_ops<D>::invoke;
+            manage = &heap_ops<D>::manage;
+        }
+
+        void reset() noexcept
+        {
+            if (manage)
+                manage(nullptr, storage);
+            invoke = nullptr;
+            manage = nullptr;
+        }
+
+        alignas(std::max_align_t) unsigned char storage[inline_size];
+        void (*invoke)(void *);
+        void (*manage)(void *, void *);
+    };
+
+    // 无参数时直接保存可调用对象，有参数时与旧接口一致使用std::bind绑定
+    template <class F>
+    static typename std::decay<F>::type bind_args(F &&f)
+    {
+        return std::forward<F>(f);
+    }
+
+    template <class F, class A, class... Args>
+    static auto bind_args(F &&f, A &&a, Args &&...args)
+        -> decltype(std::bind(std::forward<F>(f), std::forward<A>(a), std::forward<Args>(args)...))
+    {
+        return std::bind(std::forward<F>(f), std::forward<A>(a), std::forward<Args>(args)...);
+    }
+
+    void push(task &&);
+    task pop();
+
     // worker threads
     std::vector<std::thread> workers;
-    // task queue
-    std::queue<std::function<void()>> tasks;
+    // task queue（环形缓冲区，容量为2的幂，只在满时扩容）
+    std::vector<task> tasks;
+    size_t head;
+    size_t count;
 
     // synchronization
     std::mutex queue_mutex;
     std::condition_variable condition;
+    size_t idle;                // 等待中的线程数，无人等待时投递不调用notify
     bool stop;
 };
 
 inline ThreadPool::ThreadPool(size_t threads)
-    : stop(false)
+    : tasks(16), head(0), count(0), idle(0), stop(false)
 {
     for (size_t i = 0; i < threads; ++i)
     {
         workers.emplace_back([this] {
             for (;;)
             {
-                std::function<void()> task;
+                task job;
 
                 {
                     std::unique_lock<std::mutex> lock(this->queue_mutex);
-                    this->condition.wait(lock, [this] {
-                            return this->stop || !this->tasks.empty();
-                        });
-                    if (this->stop && this->tasks.empty())
+                    while (!this->stop && this->count == 0)
+                    {
+                        ++this->idle;
+                        this->condition.wait(lock);
+                        --this->idle;
+                    }
+                    if (this->stop && this->count == 0)
                         return;
-                    task = std::move(this->tasks.front());
-                    this->tasks.pop();
+                    job = this->pop();
                 }
 
-                task();
+                // submit的异常由packaged_task保存到future，post的异常无处报告，直接丢弃
+                try
+                {
+                    job();
+                }
+                catch (...)
+                {
+                }
             }
         });
     }
 }
 
+// 入队（调用方持有queue_mutex）
+inline void ThreadPool::push(task &&job)
+{
+    if (count == tasks.size())
+    {
+        std::vector<task> grown(tasks.size() * 2);
+        for (size_t i = 0; i < count; ++i)
+            grown[i] = std::move(tasks[(head + i) & (tasks.size() - 1)]);
+        tasks.swap(grown);
+        head = 0;
+    }
+    tasks[(head + count) & (tasks.size() - 1)] = std::move(job);
+    ++count;
+}
+
+// 出队（调用方持有queue_mutex）
+inline ThreadPool::task ThreadPool::pop()
+{
+    task job = std::move(tasks[head]);
+    head = (head + 1) & (tasks.size() - 1);
+    --count;
+    return job;
+}
+
 // 添加任务
 template <class F, class... Args>
-auto ThreadPool::enqueue(F &&f, Args &&...args)
-    -> std::future<typename std::result_of<F(Args...)>::type>
+auto ThreadPool::submit(F &&f, Args &&...args) -> std::future<result_t<F, Args...>>
 {
-    using return_type = typename std::result_of<F(Args...)>::type;
+    using return_type = result_t<F, Args...>;
 
-    auto task = std::make_shared<std::packaged_task<return_type()>>(
-        std::bind(std::forward<F>(f), std::forward<Args>(args)...));
-
-    std::future<return_type> res = task->get_future();
+    // packaged_task只有一次共享状态分配，其本身可以直接放入task的内部缓冲区
+    std::packaged_task<return_type()> job(bind_args(std::forward<F>(f), std::forward<Args>(args)...));
+    std::future<return_type> res = job.get_future();
+    bool wake;
     {
         std::unique_lock<std::mutex> lock(queue_mutex);
 
@@ -92,12 +273,39 @@ auto ThreadPool::enqueue(F &&f, Args &&...args)
         if (stop)
             throw std::runtime_error("enqueue on stopped ThreadPool");
 
-        tasks.emplace([task](){ (*task)(); });
+        push(task(std::move(job)));
+        wake = idle > 0;
     }
-    condition.notify_one();
+    if (wake)
+        condition.notify_one();
     return res;
 }
 
+template <class F, class... Args>
+auto ThreadPool::enqueue(F &&f, Args &&...args) -> std::future<result_t<F, Args...>>
+{
+    return submit(std::forward<F>(f), std::forward<Args>(args)...);
+}
+
+// 添加无需结果的任务
+template <class F, class... Args>
+void ThreadPool::post(F &&f, Args &&...args)
+{
+    task job(bind_args(std::forward<F>(f), std::forward<Args>(args)...));
+    bool wake;
+    {
+        std::unique_lock<std::mutex> lock(queue_mutex);
+
+        if (stop)
+            throw std::runtime_error("post on stopped ThreadPool");
+
+        push(std::move(job));
+        wake = idle > 0;
+    }
+    if (wake)
+        condition.notify_one();
+}
+
 inline ThreadPool::~ThreadPool()
 {
     {
@@ -109,4 +317,4 @@ inline ThreadPool::~ThreadPool()
         worker.join();
 }
 
-#endif  // THREADPOOL_H_
\ No newline at end of file
+#endif  // THREADPOOL_H_
@@ -0,0 +1,451 @@
+/***************************************************************
+Copyright (c) 2022-2030, shisan233@sszc.live.
+SPDX-License-Identifier: MIT
+File:        coroutine.hpp
+Version:     1.0
+Author:      cjx
+start date: 2026-10-18
+Description: ThreadPool 的 C++20 协程支持
+             coro::task<T> 惰性启动，完成后通过对称转移直接恢复等待方，不分配 std::future；
+             配合 co_await pool.schedule() 在少量工作线程上运行大量逻辑任务
+Version history
+
+[序号]    |   [修改日期]  |   [修改者]   |   [修改内容]
+1            2026-10-18       cjx         create
+
+*****************************************************************/
+
+#ifndef THREADPOOL_COROUTINE_HPP
+#define THREADPOOL_COROUTINE_HPP
+
+#include "threadpool.hpp"
+
+// 编译器未启用协程（C++17 或缺少 <coroutine>）时本文件为空
+#ifdef THREADPOOL_HAS_COROUTINE
+
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace coro
+{
+
+template <typename T = void>
+class task;
+
+namespace detail
+{
+
+// ============================================================================
+// task 的 promise
+// ============================================================================
+
+struct promise_base
+{
+    // 完成时恢复的等待方；未被 co_await 时不恢复任何协程
+    std::coroutine_handle<> continuation = std::noop_coroutine();
+    std::exception_ptr error;
+
+    struct final_awaiter
+    {
+        bool await_ready() const noexcept { return false; }
+
+        template <typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept
+        {
+            return handle.promise().continuation;
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    final_awaiter final_suspend() const noexcept { return {}; }
+    void unhandled_exception() noexcept { error = std::current_exception(); }
+};
+
+template <typename T>
+struct promise : promise_base
+{
+    task<T> get_return_object() noexcept;
+
+    template <typename U>
+    void return_value(U &&value)
+    {
+        m_value.emplace(std::forward<U>(value));
+    }
+
+    T result()
+    {
+        if (error)
+            std::rethrow_exception(error);
+        return std::move(*m_value);
+    }
+
+private:
+    std::optional<T> m_value;
+};
+
+template <>
+struct promise<void> : promise_base
+{
+    task<void> get_return_object() noexcept;
+
+    void return_void() noexcept {}
+
+    void result()
+    {
+        if (error)
+            std::rethrow_exception(error);
+    }
+};
+
+} // namespace detail
+
+// ============================================================================
+// task<T>
+// ============================================================================
+
+// 惰性协程任务：被 co_await 时才开始执行，完成后在完成它的线程上恢复等待方
+template <typename T>
+class [[nodiscard]] task
+{
+public:
+    using promise_type = detail::promise<T>;
+    using handle_type = std::coroutine_handle<promise_type>;
+    using value_type = T;
+
+    task() noexcept = default;
+    explicit task(handle_type handle) noexcept : m_handle(handle) {}
+
+    task(task &&other) noexcept : m_handle(std::exchange(other.m_handle, nullptr)) {}
+
+    task &operator=(task &&other) noexcept
+    {
+        if (this != &other)
+        {
+            if (m_handle)
+                m_handle.destroy();
+            m_handle = std::exchange(other.m_handle, nullptr);
+        }
+        return *this;
+    }
+
+    task(const task &) = delete;
+    task &operator=(const task &) = delete;
+
+    ~task()
+    {
+        if (m_handle)
+            m_handle.destroy();
+    }
+
+    [[nodiscard]] bool valid() const noexcept { return static_cast<bool>(m_handle); }
+    [[nodiscard]] bool done() const noexcept { return !m_handle || m_handle.done(); }
+
+    auto operator co_await() const noexcept
+    {
+        struct awaiter
+        {
+            handle_type handle;
+
+            bool await_ready() const noexcept { return !handle || handle.done(); }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> waiter) noexcept
+            {
+                handle.promise().continuation = waiter;
+                return handle;
+            }
+
+            T await_resume()
+            {
+                if (!handle)
+                    throw threadpool_error("co_await on an empty coro::task");
+                return handle.promise().result();
+            }
+        };
+        return awaiter{m_handle};
+    }
+
+private:
+    handle_type m_handle = nullptr;
+};
+
+namespace detail
+{
+
+template <typename T>
+task<T> promise<T>::get_return_object() noexcept
+{
+    return task<T>(std::coroutine_handle<promise<T>>::from_promise(*this));
+}
+
+inline task<void> promise<void>::get_return_object() noexcept
+{
+    return task<void>(std::coroutine_handle<promise<void>>::from_promise(*this));
+}
+
+// ============================================================================
+// 内部使用的“启动即执行”协程：完成时调用 promise 中的回调
+// ============================================================================
+
+template <typename OnDone>
+struct eager_task
+{
+    struct promise_type
+    {
+        OnDone *on_done = nullptr;
+
+        eager_task get_return_object() noexcept
+        {
+            return eager_task{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+
+        std::suspend_always initial_suspend() const noexcept { return {}; }
+
+        auto final_suspend() const noexcept
+        {
+            struct awaiter
+            {
+                bool await_ready() const noexcept { return false; }
+
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept
+                {
+                    return (*handle.promise().on_done)();
+                }
+
+                void await_resume() const noexcept {}
+            };
+            return awaiter{};
+        }
+
+        void return_void() noexcept {}
+        // 协程体内已捕获异常
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+
+    eager_task(eager_task &&other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+    eager_task(const eager_task &) = delete;
+    eager_task &operator=(const eager_task &) = delete;
+    eager_task &operator=(eager_task &&) = delete;
+
+    ~eager_task()
+    {
+        if (handle)
+            handle.destroy();
+    }
+
+    void start(OnDone &on_done)
+    {
+        handle.promise().on_done = &on_done;
+        handle.resume();
+    }
+
+    std::coroutine_handle<promise_type> handle;
+
+private:
+    explicit eager_task(std::coroutine_handle<promise_type> h) noexcept : handle(h) {}
+};
+
+template <typename T>
+using result_slot_t = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+// 等待 task 并把结果或异常写入外部槽位
+template <typename OnDone, typename T>
+eager_task<OnDone> capture(task<T> &t, std::optional<result_slot_t<T>> &slot, std::exception_ptr &error)
+{
+    try
+    {
+        if constexpr (std::is_void_v<T>)
+        {
+            co_await t;
+            slot.emplace();
+        }
+        else
+        {
+            slot.emplace(co_await t);
+        }
+    }
+    catch (...)
+    {
+        error = std::current_exception();
+    }
+}
+
+// ============================================================================
+// sync_wait 支持
+// ============================================================================
+
+// 在锁内通知：等待方返回并销毁 latch 前，通知方已不再访问它
+struct sync_latch
+{
+    std::coroutine_handle<> operator()()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        done = true;
+        cv.notify_all();
+        return std::noop_coroutine();
+    }
+
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [this] { return done; });
+    }
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool done = false;
+};
+
+// ============================================================================
+// when_all 支持
+// ============================================================================
+
+// 计数初值为 n + 1：每个子任务完成减一，等待方挂起前再减一，最后到达者恢复等待方
+struct when_all_counter
+{
+    explicit when_all_counter(std::size_t n) noexcept : count(n + 1) {}
+
+    std::coroutine_handle<> operator()() noexcept
+    {
+        if (count.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            return waiter;
+        return std::noop_coroutine();
+    }
+
+    // 返回 true 表示等待方需要挂起
+    bool try_await(std::coroutine_handle<> handle) noexcept
+    {
+        waiter = handle;
+        return count.fetch_sub(1, std::memory_order_acq_rel) > 1;
+    }
+
+    std::atomic<std::size_t> count;
+    std::coroutine_handle<> waiter;
+};
+
+using when_all_child = eager_task<when_all_counter>;
+
+struct when_all_awaiter
+{
+    when_all_counter &counter;
+    std::vector<when_all_child> &children;
+
+    bool await_ready() const noexcept { return children.empty(); }
+
+    bool await_suspend(std::coroutine_handle<> handle) noexcept
+    {
+        for (auto &child : children)
+            child.start(counter);
+        return counter.try_await(handle);
+    }
+
+    void await_resume() const noexcept {}
+};
+
+} // namespace detail
+
+// ============================================================================
+// sync_wait / when_all
+// ============================================================================
+
+// 在当前（非协程）线程阻塞等待 task 完成并返回结果，不要在本池工作线程内调用
+template <typename T>
+T sync_wait(task<T> t)
+{
+    std::optional<detail::result_slot_t<T>> slot;
+    std::exception_ptr error;
+    detail::sync_latch latch;
+
+    auto waiter = detail::capture<detail::sync_latch>(t, slot, error);
+    waiter.start(latch);
+    latch.wait();
+
+    if (error)
+        std::rethrow_exception(error);
+    if constexpr (!std::is_void_v<T>)
+        return std::move(*slot);
+}
+
+// 并发等待一组同类型 task；各 task 应先 co_await pool.schedule() 以在线程池上并行执行
+template <typename T>
+task<std::conditional_t<std::is_void_v<T>, void, std::vector<T>>> when_all(std::vector<task<T>> tasks)
+{
+    std::vector<std::optional<detail::result_slot_t<T>>> slots(tasks.size());
+    std::vector<std::exception_ptr> errors(tasks.size());
+    std::vector<detail::when_all_child> children;
+    children.reserve(tasks.size());
+    for (std::size_t i = 0; i < tasks.size(); ++i)
+        children.push_back(detail::capture<detail::when_all_counter>(tasks[i], slots[i], errors[i]));
+
+    detail::when_all_counter counter(children.size());
+    co_await detail::when_all_awaiter{counter, children};
+
+    for (auto &error : errors)
+    {
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+    if constexpr (!std::is_void_v<T>)
+    {
+        std::vector<T> results;
+        results.reserve(slots.size());
+        for (auto &slot : slots)
+            results.push_back(std::move(*slot));
+        co_return results;
+    }
+}
+
+namespace detail
+{
+
+template <typename... Ts, std::size_t... I>
+void capture_all(std::tuple<task<Ts>...> &tasks,
+                 std::tuple<std::optional<result_slot_t<Ts>>...> &slots,
+                 std::vector<std::exception_ptr> &errors,
+                 std::vector<when_all_child> &children,
+                 std::index_sequence<I...>)
+{
+    (children.push_back(capture<when_all_counter>(std::get<I>(tasks), std::get<I>(slots), errors[I])), ...);
+}
+
+} // namespace detail
+
+// 并发等待不同类型的 task，void 结果以 std::monostate 占位
+template <typename... Ts>
+task<std::tuple<detail::result_slot_t<Ts>...>> when_all(task<Ts>... tasks)
+{
+    std::tuple<task<Ts>...> owned(std::move(tasks)...);
+    std::tuple<std::optional<detail::result_slot_t<Ts>>...> slots;
+    std::vector<std::exception_ptr> errors(sizeof...(Ts));
+    std::vector<detail::when_all_child> children;
+    children.reserve(sizeof...(Ts));
+    detail::capture_all(owned, slots, errors, children, std::index_sequence_for<Ts...>{});
+
+    detail::when_all_counter counter(children.size());
+    co_await detail::when_all_awaiter{counter, children};
+
+    for (auto &error : errors)
+    {
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+    co_return std::apply([](auto &...slot) { return std::make_tuple(std::move(*slot)...); }, slots);
+}
+
+} // namespace coro
+
+#endif // THREADPOOL_HAS_COROUTINE
+
+#endif // THREADPOOL_COROUTINE_HPP
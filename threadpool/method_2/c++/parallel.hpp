@@ -0,0 +1,480 @@
+/***************************************************************
+Copyright (c) 2022-2030, shisan233@sszc.live.
+SPDX-License-Identifier: MIT
+File:        parallel.hpp
+Version:     1.0
+Author:      cjx
+start date: 2026-10-18
+Description: 基于 ThreadPool 的并行算法（for / transform / reduce / scan / sort）
+             分块按需领取（dynamic 或 guided），线程池线程与调用线程共同执行，
+             迭代耗时不均时自动平衡负载
+Version history
+
+[序号]    |   [修改日期]  |   [修改者]   |   [修改内容]
+1            2026-10-18       cjx         create
+2            2026-10-18       cjx         detach 不再做死锁检测，池内调用不再退化为串行
+3            2026-10-18       cjx         有界队列拒绝或丢弃参与者任务时由调用线程完成全部分块
+
+*****************************************************************/
+
+#ifndef THREADPOOL_PARALLEL_HPP
+#define THREADPOOL_PARALLEL_HPP
+
+#include "threadpool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace parallel
+{
+
+// ============================================================================
+// 调度选项
+// ============================================================================
+
+enum class schedule : uint8_t
+{
+    dynamic, // 固定大小分块，按需领取
+    guided   // 分块大小随剩余量递减：剩余 / (2 * 参与线程数)，不小于 grain
+};
+
+struct options
+{
+    schedule policy = schedule::guided;
+    std::size_t grain = 0;   // 最小分块大小，0 表示自动选择
+    priority_t priority = 0; // 分发到线程池的任务优先级
+};
+
+namespace detail
+{
+
+// ============================================================================
+// 分块领取
+// ============================================================================
+
+// 将 [0, n) 分块，所有参与者通过同一个原子游标领取
+class chunk_dispenser
+{
+public:
+    chunk_dispenser(std::size_t n, std::size_t grain, std::size_t participants, schedule policy) noexcept
+        : m_n(n), m_grain(grain), m_participants(participants), m_policy(policy) {}
+
+    bool next(std::size_t &begin, std::size_t &end) noexcept
+    {
+        if (m_policy == schedule::dynamic)
+        {
+            begin = m_next.fetch_add(m_grain, std::memory_order_relaxed);
+            if (begin >= m_n)
+                return false;
+            end = std::min(m_n, begin + m_grain);
+            return true;
+        }
+
+        std::size_t cur = m_next.load(std::memory_order_relaxed);
+        while (cur < m_n)
+        {
+            std::size_t size = std::max(m_grain, (m_n - cur) / (2 * m_participants));
+            std::size_t stop = std::min(m_n, cur + size);
+            if (m_next.compare_exchange_weak(cur, stop, std::memory_order_relaxed))
+            {
+                begin = cur;
+                end = stop;
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    alignas(64) std::atomic<std::size_t> m_next{0};
+    std::size_t m_n;
+    std::size_t m_grain;
+    std::size_t m_participants;
+    schedule m_policy;
+};
+
+struct plan
+{
+    std::size_t participants = 1; // 调用线程 + 线程池任务数
+    std::size_t grain = 1;
+};
+
+template <tp_flag Flags>
+plan make_plan(ThreadPool<Flags> &pool, std::size_t n, const options &opt)
+{
+    plan p;
+    std::size_t threads = pool.thread_count() + 1;
+    p.grain = opt.grain ? opt.grain : std::max<std::size_t>(1, n / (threads * 32));
+    std::size_t chunks = (n + p.grain - 1) / p.grain;
+    p.participants = std::max<std::size_t>(1, std::min(threads, chunks));
+    return p;
+}
+
+// 共享执行状态：线程池任务可能在调用方返回后才开始执行，因此由 shared_ptr 持有；
+// 此时分块已领完，迟到的任务不会再访问 body
+template <typename Body>
+struct loop_state
+{
+    loop_state(std::size_t count, const plan &p, schedule policy, Body &fn)
+        : n(count), dispenser(count, p.grain, p.participants, policy), body(&fn) {}
+
+    // 领取并执行分块直到全部领完；participant 为参与者编号（调用线程为 0）
+    void work(std::size_t participant)
+    {
+        std::size_t begin = 0;
+        std::size_t end = 0;
+        while (dispenser.next(begin, end))
+        {
+            // 出现异常后剩余分块只计数不执行
+            if (!failed.load(std::memory_order_relaxed))
+            {
+                try
+                {
+                    (*body)(begin, end, participant);
+                }
+                catch (...)
+                {
+                    if (!failed.exchange(true, std::memory_order_acq_rel))
+                        error = std::current_exception();
+                }
+            }
+            if (done.fetch_add(end - begin, std::memory_order_acq_rel) + (end - begin) == n)
+                finished.notify_all();
+        }
+    }
+
+    void wait()
+    {
+        while (done.load(std::memory_order_acquire) < n)
+        {
+            event_count::key_type key = finished.prepare_wait();
+            if (done.load(std::memory_order_acquire) >= n)
+            {
+                finished.cancel_wait();
+                break;
+            }
+            finished.commit_wait(key);
+        }
+    }
+
+    std::size_t n;
+    chunk_dispenser dispenser;
+    alignas(64) std::atomic<std::size_t> done{0};
+    std::atomic<bool> failed{false};
+    std::exception_ptr error;
+    event_count finished;
+    Body *body;
+};
+
+// 以 body(begin, end, participant) 处理 [0, n)，返回前所有分块均已执行完毕
+template <tp_flag Flags, typename Body>
+void run_chunks(ThreadPool<Flags> &pool, std::size_t n, const plan &p, const options &opt, Body &&body)
+{
+    if (n == 0)
+        return;
+    if (p.participants <= 1 || n <= p.grain)
+    {
+        body(std::size_t(0), n, std::size_t(0));
+        return;
+    }
+
+    using state_t = loop_state<std::remove_reference_t<Body>>;
+    auto state = std::make_shared<state_t>(n, p, opt.policy, body);
+
+    // 已入队的参与者引用调用方栈上的 body，提交失败也必须先领完分块、等待结束再返回；
+    // 被拒绝或被 drop_oldest 丢弃的参与者视为缺席，分块由其余参与者与调用线程领完
+    std::exception_ptr submit_error;
+    try
+    {
+        pool.detach_sequence(std::size_t(1), p.participants,
+                             [state](std::size_t id) { state->work(id); }, opt.priority);
+    }
+    catch (const queue_full &)
+    {
+    }
+    catch (...)
+    {
+        submit_error = std::current_exception();
+    }
+    state->work(0);
+    state->wait();
+
+    if (state->failed.load(std::memory_order_acquire))
+        std::rethrow_exception(state->error);
+    if (submit_error)
+        std::rethrow_exception(submit_error);
+}
+
+template <tp_flag Flags, typename Body>
+void run_chunks(ThreadPool<Flags> &pool, std::size_t n, const options &opt, Body &&body)
+{
+    run_chunks(pool, n, make_plan(pool, n, opt), opt, std::forward<Body>(body));
+}
+
+// 每个参与者独占一个槽位，避免伪共享
+template <typename T>
+struct alignas(64) padded_slot
+{
+    std::optional<T> value;
+};
+
+template <typename It>
+constexpr void require_random_access()
+{
+    static_assert(std::is_base_of_v<std::random_access_iterator_tag,
+                                    typename std::iterator_traits<It>::iterator_category>,
+                  "parallel algorithms require random access iterators");
+}
+
+} // namespace detail
+
+// ============================================================================
+// parallel_for / parallel_for_each / parallel_transform
+// ============================================================================
+
+template <tp_flag Flags, typename Index, typename F>
+void parallel_for(ThreadPool<Flags> &pool, Index first, Index last, F &&f, const options &opt = {})
+{
+    static_assert(std::is_integral_v<Index>, "parallel_for requires an integral index");
+    if (last <= first)
+        return;
+
+    std::size_t n = static_cast<std::size_t>(last - first);
+    detail::run_chunks(pool, n, opt, [&](std::size_t begin, std::size_t end, std::size_t)
+    {
+        for (std::size_t i = begin; i < end; ++i)
+            f(static_cast<Index>(first + static_cast<Index>(i)));
+    });
+}
+
+template <tp_flag Flags, typename It, typename F>
+void parallel_for_each(ThreadPool<Flags> &pool, It first, It last, F &&f, const options &opt = {})
+{
+    detail::require_random_access<It>();
+    if (last <= first)
+        return;
+
+    std::size_t n = static_cast<std::size_t>(last - first);
+    detail::run_chunks(pool, n, opt, [&](std::size_t begin, std::size_t end, std::size_t)
+    {
+        for (std::size_t i = begin; i < end; ++i)
+            f(first[i]);
+    });
+}
+
+template <tp_flag Flags, typename InIt, typename OutIt, typename UnaryOp>
+OutIt parallel_transform(ThreadPool<Flags> &pool, InIt first, InIt last, OutIt d_first,
+                         UnaryOp &&op, const options &opt = {})
+{
+    detail::require_random_access<InIt>();
+    detail::require_random_access<OutIt>();
+    if (last <= first)
+        return d_first;
+
+    std::size_t n = static_cast<std::size_t>(last - first);
+    detail::run_chunks(pool, n, opt, [&](std::size_t begin, std::size_t end, std::size_t)
+    {
+        for (std::size_t i = begin; i < end; ++i)
+            d_first[i] = op(first[i]);
+    });
+    return d_first + n;
+}
+
+// ============================================================================
+// parallel_transform_reduce / parallel_reduce
+// ============================================================================
+
+// 与 std::transform_reduce 相同，reduce 需满足结合律与交换律（分块的合并顺序不确定）
+template <tp_flag Flags, typename It, typename T, typename Reduce, typename Transform>
+T parallel_transform_reduce(ThreadPool<Flags> &pool, It first, It last, T init,
+                            Reduce &&reduce, Transform &&transform, const options &opt = {})
+{
+    detail::require_random_access<It>();
+    if (last <= first)
+        return init;
+
+    std::size_t n = static_cast<std::size_t>(last - first);
+    detail::plan p = detail::make_plan(pool, n, opt);
+    std::vector<detail::padded_slot<T>> partials(p.participants);
+
+    detail::run_chunks(pool, n, p, opt, [&](std::size_t begin, std::size_t end, std::size_t id)
+    {
+        T acc = transform(first[begin]);
+        for (std::size_t i = begin + 1; i < end; ++i)
+            acc = reduce(std::move(acc), transform(first[i]));
+
+        std::optional<T> &slot = partials[id].value;
+        if (slot)
+            slot = reduce(std::move(*slot), std::move(acc));
+        else
+            slot.emplace(std::move(acc));
+    });
+
+    T result = std::move(init);
+    for (auto &partial : partials)
+    {
+        if (partial.value)
+            result = reduce(std::move(result), std::move(*partial.value));
+    }
+    return result;
+}
+
+template <tp_flag Flags, typename It, typename T, typename Reduce>
+T parallel_reduce(ThreadPool<Flags> &pool, It first, It last, T init, Reduce &&reduce,
+                  const options &opt = {})
+{
+    return parallel_transform_reduce(pool, first, last, std::move(init), std::forward<Reduce>(reduce),
+                                     [](const auto &value) { return value; }, opt);
+}
+
+template <tp_flag Flags, typename It, typename T>
+T parallel_reduce(ThreadPool<Flags> &pool, It first, It last, T init)
+{
+    return parallel_reduce(pool, first, last, std::move(init), std::plus<>());
+}
+
+// ============================================================================
+// parallel_inclusive_scan
+// ============================================================================
+
+// 三阶段：各块并行求和 -> 串行计算块前缀 -> 各块带偏移并行扫描；op 需满足结合律
+template <tp_flag Flags, typename InIt, typename OutIt, typename BinaryOp = std::plus<>>
+OutIt parallel_inclusive_scan(ThreadPool<Flags> &pool, InIt first, InIt last, OutIt d_first,
+                              BinaryOp op = BinaryOp(), const options &opt = {})
+{
+    detail::require_random_access<InIt>();
+    detail::require_random_access<OutIt>();
+    using T = typename std::iterator_traits<InIt>::value_type;
+
+    if (last <= first)
+        return d_first;
+
+    std::size_t n = static_cast<std::size_t>(last - first);
+    detail::plan p = detail::make_plan(pool, n, opt);
+    if (p.participants <= 1)
+        return std::inclusive_scan(first, last, d_first, op);
+
+    // 块数多于参与者，按需领取块以平衡负载
+    block_range<std::size_t> blocks(0, n, p.participants * 4);
+    std::size_t nblocks = blocks.size();
+    options block_opt = opt;
+    block_opt.policy = schedule::dynamic;
+    block_opt.grain = 1;
+    detail::plan block_plan = detail::make_plan(pool, nblocks, block_opt);
+
+    std::vector<std::optional<T>> sums(nblocks);
+    detail::run_chunks(pool, nblocks, block_plan, block_opt, [&](std::size_t begin, std::size_t end, std::size_t)
+    {
+        for (std::size_t b = begin; b < end; ++b)
+        {
+            std::size_t lo = blocks.start(b);
+            std::size_t hi = blocks.end(b);
+            T acc = first[lo];
+            for (std::size_t i = lo + 1; i < hi; ++i)
+                acc = op(std::move(acc), first[i]);
+            sums[b].emplace(std::move(acc));
+        }
+    });
+
+    // sums[b] 改为块 b 之前所有元素的前缀（块 0 无前缀）
+    std::optional<T> carry;
+    for (std::size_t b = 0; b < nblocks; ++b)
+    {
+        std::optional<T> prefix = carry;
+        carry = carry ? op(std::move(*carry), std::move(*sums[b])) : std::move(sums[b]);
+        sums[b] = std::move(prefix);
+    }
+
+    detail::run_chunks(pool, nblocks, block_plan, block_opt, [&](std::size_t begin, std::size_t end, std::size_t)
+    {
+        for (std::size_t b = begin; b < end; ++b)
+        {
+            std::size_t lo = blocks.start(b);
+            std::size_t hi = blocks.end(b);
+            T acc = sums[b] ? op(*sums[b], first[lo]) : T(first[lo]);
+            d_first[lo] = acc;
+            for (std::size_t i = lo + 1; i < hi; ++i)
+            {
+                acc = op(std::move(acc), first[i]);
+                d_first[i] = acc;
+            }
+        }
+    });
+    return d_first + n;
+}
+
+// ============================================================================
+// parallel_sort
+// ============================================================================
+
+// 小于该长度时直接 std::sort
+#ifndef THREADPOOL_PARALLEL_SORT_CUTOFF
+#define THREADPOOL_PARALLEL_SORT_CUTOFF 8192
+#endif
+
+// 先并行排序各块，再逐轮两两归并（每轮内并行）；不保证稳定
+template <tp_flag Flags, typename It, typename Compare = std::less<>>
+void parallel_sort(ThreadPool<Flags> &pool, It first, It last, Compare comp = Compare(),
+                   const options &opt = {})
+{
+    detail::require_random_access<It>();
+    if (last <= first)
+        return;
+
+    std::size_t n = static_cast<std::size_t>(last - first);
+    detail::plan p = detail::make_plan(pool, n, opt);
+    if (n < THREADPOOL_PARALLEL_SORT_CUTOFF || p.participants <= 1)
+    {
+        std::sort(first, last, comp);
+        return;
+    }
+
+    // 块数取 2 的幂，约为参与者的两倍，且每块不小于 cutoff / 2
+    std::size_t nblocks = 1;
+    while (nblocks < p.participants * 2 && n / (nblocks * 2) >= THREADPOOL_PARALLEL_SORT_CUTOFF / 2)
+        nblocks *= 2;
+    block_range<std::size_t> blocks(0, n, nblocks);
+    nblocks = blocks.size();
+
+    options block_opt = opt;
+    block_opt.policy = schedule::dynamic;
+    block_opt.grain = 1;
+
+    detail::run_chunks(pool, nblocks, block_opt, [&](std::size_t begin, std::size_t end, std::size_t)
+    {
+        for (std::size_t b = begin; b < end; ++b)
+            std::sort(first + blocks.start(b), first + blocks.end(b), comp);
+    });
+
+    for (std::size_t width = 1; width < nblocks; width *= 2)
+    {
+        std::size_t pairs = (nblocks + 2 * width - 1) / (2 * width);
+        detail::run_chunks(pool, pairs, block_opt, [&](std::size_t begin, std::size_t end, std::size_t)
+        {
+            for (std::size_t pair = begin; pair < end; ++pair)
+            {
+                std::size_t left = pair * 2 * width;
+                std::size_t right = left + width;
+                if (right >= nblocks)
+                    continue;
+                std::size_t last_block = std::min(nblocks, right + width) - 1;
+                std::inplace_merge(first + blocks.start(left), first + blocks.start(right),
+                                   first + blocks.end(last_block), comp);
+            }
+        });
+    }
+}
+
+} // namespace parallel
+
+#endif // THREADPOOL_PARALLEL_HPP
@@ -0,0 +1,536 @@
+/***************************************************************
+Copyright (c) 2022-2030, shisan233@sszc.live.
+SPDX-License-Identifier: MIT
+File:        task_graph.hpp
+Version:     1.0
+Author:      cjx
+start date: 2026-10-18
+Description: 基于 ThreadPool 的任务依赖图（DAG）执行器
+             节点的依赖全部完成后立即投递到线程池，工作线程内不做任何阻塞等待
+Version history
+
+[序号]    |   [修改日期]  |   [修改者]   |   [修改内容]
+1            2026-10-18       cjx         create
+2            2026-10-18       cjx         有界队列拒绝或丢弃的节点作业改为就地执行，避免 wait 永久阻塞
+
+*****************************************************************/
+
+#ifndef THREADPOOL_TASK_GRAPH_HPP
+#define THREADPOOL_TASK_GRAPH_HPP
+
+#include "threadpool.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+class TaskGraph;
+
+// ============================================================================
+// 图节点句柄
+// ============================================================================
+
+class Task
+{
+public:
+    Task() = default;
+
+    [[nodiscard]] bool empty() const noexcept { return m_graph == nullptr; }
+
+    // this 完成后才能执行 others
+    template <typename... Ts>
+    Task &precede(Ts &&...others);
+
+    // others 全部完成后才能执行 this
+    template <typename... Ts>
+    Task &succeed(Ts &&...others);
+
+    // 在本节点之后追加一个新节点，返回新节点
+    template <typename F>
+    Task then(F &&work);
+
+    Task &name(std::string label);
+    [[nodiscard]] const std::string &name() const;
+
+private:
+    friend class TaskGraph;
+
+    Task(TaskGraph *graph, std::size_t index) noexcept
+        : m_graph(graph), m_index(index) {}
+
+    TaskGraph *m_graph = nullptr;
+    std::size_t m_index = 0;
+};
+
+// ============================================================================
+// 单次执行状态与句柄
+// ============================================================================
+
+struct graph_run_state;
+
+// TaskGraph::run 的返回值：可在外部线程等待，也可注册完成后在线程池上执行的后续任务
+class GraphRun
+{
+public:
+    GraphRun() = default;
+
+    [[nodiscard]] bool valid() const noexcept { return m_state != nullptr; }
+    [[nodiscard]] bool ready() const noexcept;
+
+    // 阻塞等待整张图执行完毕，不要在本池工作线程内调用，工作线程内请使用 then()
+    void wait() const;
+
+    template <typename Rep, typename Period>
+    bool wait_for(const std::chrono::duration<Rep, Period> &duration) const;
+
+    // 等待并重新抛出第一个节点异常
+    void get() const;
+
+    // 整张图完成后在线程池上执行 work；已完成时立即投递
+    template <typename F>
+    void then(F &&work) const;
+
+private:
+    friend class TaskGraph;
+
+    explicit GraphRun(std::shared_ptr<graph_run_state> state)
+        : m_state(std::move(state)) {}
+
+    std::shared_ptr<graph_run_state> m_state;
+};
+
+// ============================================================================
+// 任务依赖图
+// ============================================================================
+
+// 图可重复执行，也可同时执行多次（每次执行有独立的依赖计数）；
+// 执行期间图本身与线程池必须保持存活且不可修改
+class TaskGraph
+{
+public:
+    TaskGraph() = default;
+    TaskGraph(const TaskGraph &) = delete;
+    TaskGraph &operator=(const TaskGraph &) = delete;
+
+    template <typename F>
+    Task emplace(F &&work)
+    {
+        m_nodes.emplace_back();
+        m_nodes.back().work = move_only_function<void()>(std::forward<F>(work));
+        m_validated = false;
+        return Task(this, m_nodes.size() - 1);
+    }
+
+    template <typename... Fs, typename = std::enable_if_t<(sizeof...(Fs) > 1)>>
+    auto emplace(Fs &&...works)
+    {
+        return std::make_tuple(emplace(std::forward<Fs>(works))...);
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept { return m_nodes.size(); }
+    [[nodiscard]] bool empty() const noexcept { return m_nodes.empty(); }
+
+    void clear()
+    {
+        m_nodes.clear();
+        m_sources.clear();
+        m_validated = false;
+    }
+
+    // 投递所有无依赖节点后立即返回；图中存在环时抛出 threadpool_error
+    template <tp_flag Flags>
+    GraphRun run(ThreadPool<Flags> &pool, priority_t priority = 0);
+
+private:
+    friend class Task;
+    friend struct graph_run_state;
+
+    struct node
+    {
+        move_only_function<void()> work;
+        std::vector<std::size_t> successors;
+        std::size_t in_degree = 0;
+        std::string name;
+    };
+
+    void add_edge(std::size_t from, std::size_t to)
+    {
+        m_nodes[from].successors.push_back(to);
+        ++m_nodes[to].in_degree;
+        m_validated = false;
+    }
+
+    // Kahn 拓扑排序检查环，同时记录源节点
+    void validate()
+    {
+        if (m_validated)
+            return;
+
+        std::vector<std::size_t> degree(m_nodes.size());
+        std::vector<std::size_t> ready;
+        for (std::size_t i = 0; i < m_nodes.size(); ++i)
+        {
+            degree[i] = m_nodes[i].in_degree;
+            if (degree[i] == 0)
+                ready.push_back(i);
+        }
+        m_sources = ready;
+
+        std::size_t visited = 0;
+        while (!ready.empty())
+        {
+            std::size_t cur = ready.back();
+            ready.pop_back();
+            ++visited;
+            for (std::size_t next : m_nodes[cur].successors)
+            {
+                if (--degree[next] == 0)
+                    ready.push_back(next);
+            }
+        }
+        if (visited != m_nodes.size())
+            throw threadpool_error("TaskGraph contains a cycle");
+        m_validated = true;
+    }
+
+    std::vector<node> m_nodes;
+    std::vector<std::size_t> m_sources;
+    bool m_validated = false;
+};
+
+// ============================================================================
+// 执行状态
+// ============================================================================
+
+namespace graph_detail
+{
+
+// 投递到线程池的作业在未执行就被销毁时（入队被拒绝、线程池已停止、被 drop_oldest 丢弃）
+// 改为在析构处执行，保证图的计数最终归零，不会因有界队列而永久等待
+template <typename F>
+class must_run
+{
+public:
+    explicit must_run(F &&fn) : m_fn(std::move(fn)) {}
+
+    must_run(must_run &&other) noexcept
+        : m_fn(std::move(other.m_fn)), m_armed(std::exchange(other.m_armed, false)) {}
+
+    must_run(const must_run &) = delete;
+    must_run &operator=(const must_run &) = delete;
+    must_run &operator=(must_run &&) = delete;
+
+    ~must_run()
+    {
+        if (!m_armed)
+            return;
+        try
+        {
+            m_fn();
+        }
+        catch (...)
+        {
+        }
+    }
+
+    void operator()()
+    {
+        m_armed = false;
+        m_fn();
+    }
+
+private:
+    F m_fn;
+    bool m_armed = true;
+};
+
+template <typename F>
+must_run<std::decay_t<F>> make_must_run(F &&fn)
+{
+    return must_run<std::decay_t<F>>(std::forward<F>(fn));
+}
+
+} // namespace graph_detail
+
+struct graph_run_state : std::enable_shared_from_this<graph_run_state>
+{
+    using post_type = move_only_function<void(move_only_function<void()> &&)>;
+
+    // 当前线程正在推进的执行状态及其就绪列表：同一状态的作业在此线程上被拒绝或丢弃时
+    // 压入列表由外层循环执行，避免在析构中递归
+    struct ready_scope
+    {
+        ready_scope(graph_run_state *s, std::vector<std::size_t> &r) noexcept
+            : state(s), ready(r), prev(current())
+        {
+            current() = this;
+        }
+
+        ~ready_scope() { current() = prev; }
+
+        ready_scope(const ready_scope &) = delete;
+        ready_scope &operator=(const ready_scope &) = delete;
+
+        static ready_scope *&current() noexcept
+        {
+            thread_local ready_scope *scope = nullptr;
+            return scope;
+        }
+
+        graph_run_state *state;
+        std::vector<std::size_t> &ready;
+        ready_scope *prev;
+    };
+
+    graph_run_state(TaskGraph &g, post_type &&poster)
+        : graph(&g)
+        , pending(new std::atomic<std::size_t>[g.m_nodes.size()])
+        , remaining(g.m_nodes.size())
+        , post(std::move(poster))
+    {
+        for (std::size_t i = 0; i < g.m_nodes.size(); ++i)
+            pending[i].store(g.m_nodes[i].in_degree, std::memory_order_relaxed);
+    }
+
+    move_only_function<void()> make_job(std::size_t index)
+    {
+        return graph_detail::make_must_run([self = shared_from_this(), index]() { self->run(index); });
+    }
+
+    // 线程池执行作业或作业未执行即被销毁时调用
+    void run(std::size_t index)
+    {
+        ready_scope *scope = ready_scope::current();
+        if (scope != nullptr && scope->state == this)
+            scope->ready.push_back(index);
+        else
+            execute(index);
+    }
+
+    // 执行节点并释放后继；第一个就绪的后继在当前线程继续执行，其余投递到线程池，
+    // 投递失败的后继进入本地就绪列表
+    void execute(std::size_t index)
+    {
+        constexpr std::size_t none = static_cast<std::size_t>(-1);
+        std::vector<std::size_t> ready{index};
+        ready_scope scope(this, ready);
+        while (!ready.empty())
+        {
+            std::size_t current = ready.back();
+            ready.pop_back();
+            TaskGraph::node &n = graph->m_nodes[current];
+
+            // 出现异常后剩余节点只推进依赖，不再执行
+            if (!failed.load(std::memory_order_acquire))
+            {
+                try
+                {
+                    n.work();
+                }
+                catch (...)
+                {
+                    if (!failed.exchange(true, std::memory_order_acq_rel))
+                        error = std::current_exception();
+                }
+            }
+
+            std::size_t next = none;
+            for (std::size_t succ : n.successors)
+            {
+                if (pending[succ].fetch_sub(1, std::memory_order_acq_rel) != 1)
+                    continue;
+                if (next == none)
+                    next = succ;
+                else
+                    post(make_job(succ));
+            }
+
+            if (next != none)
+                ready.push_back(next);
+            if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                finish();
+        }
+    }
+
+    void finish()
+    {
+        std::vector<move_only_function<void()>> callbacks;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            finished = true;
+            callbacks.swap(continuations);
+        }
+        done_event.notify_all();
+        for (auto &cb : callbacks)
+            post(graph_detail::make_must_run(std::move(cb)));
+    }
+
+    [[nodiscard]] bool is_finished() const noexcept
+    {
+        return remaining.load(std::memory_order_acquire) == 0;
+    }
+
+    void add_continuation(move_only_function<void()> &&cb)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!finished)
+            {
+                continuations.push_back(std::move(cb));
+                return;
+            }
+        }
+        post(graph_detail::make_must_run(std::move(cb)));
+    }
+
+    TaskGraph *graph;
+    std::unique_ptr<std::atomic<std::size_t>[]> pending;
+    alignas(64) std::atomic<std::size_t> remaining;
+    std::atomic<bool> failed{false};
+    std::exception_ptr error;
+    event_count done_event;
+    post_type post;
+
+    std::mutex mutex;
+    bool finished = false;
+    std::vector<move_only_function<void()>> continuations;
+};
+
+// ============================================================================
+// 实现
+// ============================================================================
+
+template <typename... Ts>
+Task &Task::precede(Ts &&...others)
+{
+    (m_graph->add_edge(m_index, others.m_index), ...);
+    return *this;
+}
+
+template <typename... Ts>
+Task &Task::succeed(Ts &&...others)
+{
+    (m_graph->add_edge(others.m_index, m_index), ...);
+    return *this;
+}
+
+template <typename F>
+Task Task::then(F &&work)
+{
+    Task next = m_graph->emplace(std::forward<F>(work));
+    precede(next);
+    return next;
+}
+
+inline Task &Task::name(std::string label)
+{
+    m_graph->m_nodes[m_index].name = std::move(label);
+    return *this;
+}
+
+inline const std::string &Task::name() const
+{
+    return m_graph->m_nodes[m_index].name;
+}
+
+inline bool GraphRun::ready() const noexcept
+{
+    return !m_state || m_state->is_finished();
+}
+
+inline void GraphRun::wait() const
+{
+    if (!m_state)
+        return;
+    while (!m_state->is_finished())
+    {
+        event_count::key_type key = m_state->done_event.prepare_wait();
+        if (m_state->is_finished())
+        {
+            m_state->done_event.cancel_wait();
+            break;
+        }
+        m_state->done_event.commit_wait(key);
+    }
+}
+
+template <typename Rep, typename Period>
+bool GraphRun::wait_for(const std::chrono::duration<Rep, Period> &duration) const
+{
+    if (!m_state)
+        return true;
+    auto deadline = std::chrono::steady_clock::now() + duration;
+    while (!m_state->is_finished())
+    {
+        event_count::key_type key = m_state->done_event.prepare_wait();
+        if (m_state->is_finished())
+        {
+            m_state->done_event.cancel_wait();
+            break;
+        }
+        if (!m_state->done_event.commit_wait_until(key, deadline))
+            return m_state->is_finished();
+    }
+    return true;
+}
+
+inline void GraphRun::get() const
+{
+    wait();
+    if (m_state && m_state->failed.load(std::memory_order_acquire))
+        std::rethrow_exception(m_state->error);
+}
+
+template <typename F>
+void GraphRun::then(F &&work) const
+{
+    if (m_state)
+        m_state->add_continuation(move_only_function<void()>(std::forward<F>(work)));
+}
+
+template <tp_flag Flags>
+GraphRun TaskGraph::run(ThreadPool<Flags> &pool, priority_t priority)
+{
+    validate();
+
+    // 作业均由 must_run 包装：被拒绝或丢弃时就地执行，这里忽略投递结果
+    auto state = std::make_shared<graph_run_state>(
+        *this,
+        [&pool, priority](move_only_function<void()> &&job) { (void)pool.try_detach(std::move(job), priority); });
+
+    if (m_nodes.empty())
+    {
+        state->finish();
+        return GraphRun(std::move(state));
+    }
+
+    // 批量投递时被拒绝的源节点先收集到本地列表，投递结束后在调用线程执行
+    std::vector<std::size_t> rejected;
+    {
+        graph_run_state::ready_scope scope(state.get(), rejected);
+        std::vector<move_only_function<void()>> jobs;
+        jobs.reserve(m_sources.size());
+        for (std::size_t src : m_sources)
+            jobs.push_back(state->make_job(src));
+        try
+        {
+            pool.detach_bulk(std::make_move_iterator(jobs.begin()), std::make_move_iterator(jobs.end()), priority);
+        }
+        catch (const queue_full &)
+        {
+        }
+    }
+    for (std::size_t src : rejected)
+        state->execute(src);
+    return GraphRun(std::move(state));
+}
+
+#endif // THREADPOOL_TASK_GRAPH_HPP
@@ -12,33 +12,72 @@ Version history
 [序号]    |   [修改日期]  |   [修改者]   |   [修改内容]
 1            2025-01-01       cjx         create
 2            2025-04-14       cjx         线程增减逻辑，借鉴C版本双队列设计
+3            2026-10-18       cjx         work_stealing 模式（每线程 Chase-Lev 双端队列）
+4            2026-10-18       cjx         move_only_function 小对象内联存储，任务节点复用
+5            2026-10-18       cjx         原子计数 + event_count 空闲唤醒，wait() 基于完成计数
+6            2026-10-18       cjx         空闲线程自适应自旋后再休眠
+7            2026-10-18       cjx         批量入队，整批只加一次锁并按批量唤醒
+8            2026-10-18       cjx         submit_blocks/submit_loop 返回 task_group，等待方协助执行
+9            2026-10-18       cjx         detach 系列不阻塞，不再做死锁检测（供 TaskGraph 在工作线程内调度）
+10           2026-10-18       cjx         C++20 协程：co_await pool.schedule()
+11           2026-10-18       cjx         工作线程 CPU 亲和性、NUMA 放置、线程名与调度策略
+12           2026-10-18       cjx         全局队列容量上限与溢出策略（阻塞/拒绝/调用方执行/丢弃最旧）
+13           2026-10-18       cjx         优先级模式改为 8 段 FIFO + 位图，O(1) 出入队且跨双队列严格有序
+14           2026-10-18       cjx         定时任务 schedule_after/schedule_at/schedule_every，由空闲工作线程维护定时堆
+15           2026-10-18       cjx         tp_flag::metrics：排队/执行耗时直方图、线程忙闲比、窃取/交换次数
 
 *****************************************************************/
 
 #ifndef THREADPOOL_HPP
 #define THREADPOOL_HPP
 
+#include <algorithm>
+#include <array>
 #include <atomic>
 #include <chrono>
+#include <climits>
 #include <condition_variable>
+#include <cstddef>
 #include <cstdint>
 #include <exception>
+#include <fstream>
 #include <functional>
 #include <future>
 #include <memory>
 #include <mutex>
+#include <new>
 #include <optional>
-#include <queue>
 #include <string>
 #include <thread>
 #include <type_traits>
 #include <utility>
+#include <variant>
 #include <vector>
 
 #ifdef __cpp_lib_jthread
 #include <stop_token>
 #endif
 
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#include <coroutine>
+#define THREADPOOL_HAS_COROUTINE 1
+#endif
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <immintrin.h>
+#endif
+
+#if defined(__linux__)
+#include <ctime>
+#include <linux/futex.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 // ============================================================================
 // 配置标志
 // ============================================================================
@@ -48,7 +87,9 @@ enum class tp_flag : uint8_t
     none = 0,
     priority = 1 << 0,      // 启用任务优先级
     pause = 1 << 1,         // 启用暂停功能
-    deadlock_check = 1 << 2 // 启用死锁检测
+    deadlock_check = 1 << 2, // 启用死锁检测
+    work_stealing = 1 << 3, // 工作线程内提交的任务进入本线程双端队列，空闲线程随机窃取
+    metrics = 1 << 4        // 记录排队/执行耗时直方图、线程忙闲比与窃取/交换次数（关闭时完全不编译）
 };
 
 constexpr tp_flag operator|(tp_flag a, tp_flag b) noexcept
@@ -82,6 +123,36 @@ public:
     deadlock_detected() : threadpool_error("Deadlock detected in thread pool operation") {}
 };
 
+class queue_full : public threadpool_error
+{
+public:
+    queue_full() : threadpool_error("Thread pool task queue is full") {}
+};
+
+// ============================================================================
+// 队列容量与溢出策略
+// ============================================================================
+
+// 全局队列达到容量上限时的处理方式（工作线程本地队列不受限制）
+enum class overflow_policy : uint8_t
+{
+    block,        // 阻塞等待空位，超时视为拒绝；在本池工作线程内提交时改为 caller_runs
+    reject,       // 立即拒绝：try_detach 返回 false，其余提交接口抛出 queue_full
+    caller_runs,  // 在提交线程上直接执行
+    drop_oldest   // 丢弃最旧的任务（优先级模式下为最低优先级中的任务）；新任务优先级更低时拒绝新任务
+};
+
+struct queue_stats
+{
+    std::size_t depth = 0;          // 全局队列当前任务数
+    std::size_t capacity = 0;       // 0 表示不限
+    std::size_t high_water = 0;     // 历史最大深度
+    std::uint64_t blocked = 0;      // 因队列满而等待过的提交次数
+    std::uint64_t rejected = 0;     // 被拒绝的任务数（含阻塞超时）
+    std::uint64_t dropped = 0;      // drop_oldest 丢弃的任务数
+    std::uint64_t caller_ran = 0;   // caller_runs 在提交线程上执行的任务数
+};
+
 // ============================================================================
 // 优先级定义
 // ============================================================================
@@ -101,6 +172,11 @@ enum class pr : priority_t
 // move_only_function 兼容 (C++17)
 // ============================================================================
 
+// 小对象内联存储容量（字节），不超过此大小且可 noexcept 移动的可调用对象不分配堆内存
+#ifndef THREADPOOL_TASK_INLINE_SIZE
+#define THREADPOOL_TASK_INLINE_SIZE 56
+#endif
+
 #ifdef __cpp_lib_move_only_function
 template <typename T>
 using move_only_function = std::move_only_function<T>;
@@ -112,77 +188,229 @@ template <typename R, typename... Args>
 class move_only_function<R(Args...)>
 {
 public:
+    static constexpr std::size_t inline_size = THREADPOOL_TASK_INLINE_SIZE;
+
     move_only_function() noexcept = default;
-    move_only_function(move_only_function &&) noexcept = default;
-    move_only_function &operator=(move_only_function &&) noexcept = default;
+
+    move_only_function(move_only_function &&other) noexcept
+    {
+        move_from(other);
+    }
+
+    move_only_function &operator=(move_only_function &&other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            move_from(other);
+        }
+        return *this;
+    }
 
     move_only_function(const move_only_function &) = delete;
     move_only_function &operator=(const move_only_function &) = delete;
 
-    ~move_only_function() = default;
+    ~move_only_function()
+    {
+        reset();
+    }
 
     template <typename F,
               typename = std::enable_if_t<
                   !std::is_same_v<std::decay_t<F>, move_only_function> &&
-                  std::is_invocable_r_v<R, F &, Args...>>>
+                  std::is_invocable_r_v<R, std::decay_t<F> &, Args...>>>
     move_only_function(F &&f)
-        : ptr(std::make_unique<model<std::decay_t<F>>>(std::forward<F>(f))) {}
+    {
+        using D = std::decay_t<F>;
+        if constexpr (stored_inline<D>)
+        {
+            ::new (static_cast<void *>(m_storage)) D(std::forward<F>(f));
+        }
+        else
+        {
+            *reinterpret_cast<D **>(m_storage) = new D(std::forward<F>(f));
+        }
+        m_vtable = &vtable_for<D>;
+    }
 
     R operator()(Args... args)
     {
-        if (!ptr)
+        if (!m_vtable)
             throw std::bad_function_call();
-        return ptr->call(std::forward<Args>(args)...);
+        return m_vtable->invoke(m_storage, std::forward<Args>(args)...);
     }
 
     explicit operator bool() const noexcept
     {
-        return ptr != nullptr;
+        return m_vtable != nullptr;
     }
 
     void reset() noexcept
     {
-        ptr.reset();
+        if (m_vtable)
+        {
+            m_vtable->destroy(m_storage);
+            m_vtable = nullptr;
+        }
     }
 
 private:
-    struct concept
+    // 手写虚表：内联对象与堆对象共用同一接口
+    struct vtable
     {
-        virtual ~concept() = default;
-        virtual R call(Args... args) = 0;
+        R (*invoke)(void *, Args &&...);
+        void (*move)(void *dst, void *src) noexcept;
+        void (*destroy)(void *) noexcept;
     };
 
+    template <typename D>
+    static constexpr bool stored_inline =
+        sizeof(D) <= inline_size &&
+        alignof(D) <= alignof(std::max_align_t) &&
+        std::is_nothrow_move_constructible_v<D>;
+
+    template <typename D>
+    static D &target(void *storage) noexcept
+    {
+        if constexpr (stored_inline<D>)
+            return *std::launder(reinterpret_cast<D *>(storage));
+        else
+            return **reinterpret_cast<D **>(storage);
+    }
+
+    template <typename D>
+    static R invoke_impl(void *storage, Args &&...args)
+    {
+        if constexpr (std::is_void_v<R>)
+            std::invoke(target<D>(storage), std::forward<Args>(args)...);
+        else
+            return std::invoke(target<D>(storage), std::forward<Args>(args)...);
+    }
+
+    template <typename D>
+    static void move_impl(void *dst, void *src) noexcept
+    {
+        if constexpr (stored_inline<D>)
+        {
+            D &from = target<D>(src);
+            ::new (dst) D(std::move(from));
+            from.~D();
+        }
+        else
+        {
+            *reinterpret_cast<D **>(dst) = *reinterpret_cast<D **>(src);
+        }
+    }
+
+    template <typename D>
+    static void destroy_impl(void *storage) noexcept
+    {
+        if constexpr (stored_inline<D>)
+            target<D>(storage).~D();
+        else
+            delete *reinterpret_cast<D **>(storage);
+    }
+
+    template <typename D>
+    static constexpr vtable vtable_for = {&invoke_impl<D>, &move_impl<D>, &destroy_impl<D>};
+
+    void move_from(move_only_function &other) noexcept
+    {
+        if (other.m_vtable)
+        {
+            other.m_vtable->move(m_storage, other.m_storage);
+            m_vtable = std::exchange(other.m_vtable, nullptr);
+        }
+    }
+
+    static_assert(inline_size >= sizeof(void *), "inline storage must hold a pointer");
+
+    alignas(std::max_align_t) unsigned char m_storage[inline_size];
+    const vtable *m_vtable = nullptr;
+};
+#endif
+
+// ============================================================================
+// 任务节点缓存（work_stealing 本地队列使用）
+// ============================================================================
+
+// 线程本地的空闲节点栈：节点由执行线程回收、提交线程复用，
+// 配合内联存储，本地提交的常见路径不再分配内存；Node 为含 task 成员的任务包装
+template <typename Node>
+class task_node_cache
+{
+public:
+    using node_type = Node;
+
+    static constexpr std::size_t max_cached = 1024;
+
     template <typename F>
-    struct model final : concept
+    static node_type *acquire(F &&task)
     {
-        explicit model(F &&f) : func(std::forward<F>(f)) {}
-        R call(Args... args) override
+        auto &nodes = local();
+        if (nodes.empty())
+            return new node_type(move_only_function<void()>(std::forward<F>(task)));
+
+        node_type *node = nodes.back();
+        nodes.pop_back();
+        node->task = move_only_function<void()>(std::forward<F>(task));
+        return node;
+    }
+
+    static void release(node_type *node) noexcept
+    {
+        node->task.reset();
+        auto &nodes = local();
+        if (nodes.size() < max_cached)
         {
-            if constexpr (std::is_void_v<R>)
-            {
-                std::invoke(func, std::forward<Args>(args)...);
-            }
-            else
+            try
             {
-                return std::invoke(func, std::forward<Args>(args)...);
+                nodes.push_back(node);
+                return;
             }
+            catch (...) {}
+        }
+        delete node;
+    }
+
+private:
+    struct node_stack : std::vector<node_type *>
+    {
+        ~node_stack()
+        {
+            for (node_type *node : *this)
+                delete node;
         }
-        F func;
     };
 
-    std::unique_ptr<concept> ptr;
+    static node_stack &local()
+    {
+        thread_local node_stack nodes;
+        return nodes;
+    }
 };
-#endif
 
 // ============================================================================
 // 优先级任务包装
 // ============================================================================
 
-template <bool PriorityEnabled>
-struct task_wrapper;
+// metrics 模式下记录入队时间（steady_clock 纳秒），关闭时为空基类不占空间
+template <bool MetricsEnabled>
+struct task_stamp
+{
+};
 
 template <>
-struct task_wrapper<true>
+struct task_stamp<true>
+{
+    std::int64_t enqueue_ns = 0;
+};
+
+template <bool PriorityEnabled, bool MetricsEnabled = false>
+struct task_wrapper;
+
+template <bool MetricsEnabled>
+struct task_wrapper<true, MetricsEnabled> : task_stamp<MetricsEnabled>
 {
     move_only_function<void()> task;
     priority_t priority;
@@ -190,16 +418,10 @@ struct task_wrapper<true>
     task_wrapper() = default;
     task_wrapper(move_only_function<void()> &&t, priority_t p = 0)
         : task(std::move(t)), priority(p) {}
-
-    // 优先级队列需要 operator<，高优先级先出队
-    bool operator<(const task_wrapper &other) const
-    {
-        return priority < other.priority;
-    }
 };
 
-template <>
-struct task_wrapper<false>
+template <bool MetricsEnabled>
+struct task_wrapper<false, MetricsEnabled> : task_stamp<MetricsEnabled>
 {
     move_only_function<void()> task;
 
@@ -266,6 +488,9 @@ class multi_future : public std::vector<std::future<T>>
 public:
     using std::vector<std::future<T>>::vector;
 
+    multi_future(std::vector<std::future<T>> &&futures)
+        : std::vector<std::future<T>>(std::move(futures)) {}
+
     [[nodiscard]] std::conditional_t<std::is_void_v<T>, void, std::vector<T>> get()
     {
         if constexpr (std::is_void_v<T>)
@@ -384,164 +609,1452 @@ private:
 
     static inline thread_local std::optional<std::size_t> s_index = std::nullopt;
     static inline thread_local std::optional<void *> s_pool = std::nullopt;
+    static inline thread_local void *s_local_queue = nullptr;   // work_stealing 模式下本线程的双端队列
 };
 
+#ifdef THREADPOOL_HAS_COROUTINE
 // ============================================================================
-// 双队列任务管理器（借鉴 C 版本的 __taskqueue_swap 设计）
+// 协程恢复作业
 // ============================================================================
 
-template <bool PriorityEnabled>
-class dual_task_queue
+// schedule() 投递的作业：入队后未执行即被销毁（drop_oldest 丢弃、purge、停止后析构）时
+// 在析构处恢复协程，避免其永久挂起；提交时被拒绝则由 await_suspend 返回 false 继续执行
+class resume_job
 {
-    using task_type = task_wrapper<PriorityEnabled>;
-    using queue_type = std::conditional_t<
-        PriorityEnabled,
-        std::priority_queue<task_type>,
-        std::queue<task_type>>;
-
 public:
-    dual_task_queue() = default;
+    explicit resume_job(std::coroutine_handle<> handle) noexcept : m_handle(handle) {}
+    resume_job(resume_job &&other) noexcept : m_handle(std::exchange(other.m_handle, nullptr)) {}
+    resume_job(const resume_job &) = delete;
+    resume_job &operator=(const resume_job &) = delete;
+    resume_job &operator=(resume_job &&) = delete;
 
-    // 生产者端：放入任务
-    void put(task_type &&task)
+    ~resume_job()
     {
-        std::lock_guard<std::mutex> lock(m_put_mutex);
-        put_impl(std::move(task));
+        if (m_handle && m_handle.address() != s_submitting)
+            m_handle.resume();
     }
 
-    // 生产者端：放入任务到头部（用于特殊任务）
-    void put_front(task_type &&task)
+    void operator()() { std::exchange(m_handle, nullptr).resume(); }
+
+private:
+    template <tp_flag>
+    friend class ThreadPool;
+
+    static inline thread_local void *s_submitting = nullptr;    // 当前线程正在提交的协程
+    std::coroutine_handle<> m_handle;
+};
+#endif
+
+// ============================================================================
+// Chase-Lev 工作窃取双端队列
+// ============================================================================
+
+// 所有者在底部 push/pop（LIFO），其他线程从顶部 steal（FIFO）
+// 参考 Lê et al. "Correct and Efficient Work-Stealing for Weak Memory Models"
+template <typename T>
+class ws_deque
+{
+    static_assert(std::is_trivially_copyable_v<T>, "ws_deque element must be trivially copyable");
+
+public:
+    explicit ws_deque(std::size_t capacity = 256)
     {
-        std::lock_guard<std::mutex> lock(m_put_mutex);
-        put_front_impl(std::move(task));
+        std::size_t cap = 1;
+        while (cap < capacity)
+            cap <<= 1;
+        m_rings.push_back(std::make_unique<ring>(cap));
+        m_array.store(m_rings.back().get(), std::memory_order_relaxed);
     }
 
-    // 消费者端：获取任务（批量交换后从消费者队列获取）
-    std::optional<task_type> get()
+    ws_deque(const ws_deque &) = delete;
+    ws_deque &operator=(const ws_deque &) = delete;
+
+    // 仅所有者线程调用
+    void push(T item)
     {
-        std::lock_guard<std::mutex> lock(m_get_mutex);
-        
-        // 如果消费者队列为空，尝试与生产者队列交换
-        if (consumer_empty())
-        {
-            swap_queues();
-        }
-        
-        if (consumer_empty())
-            return std::nullopt;
-            
-        return take_from_consumer();
+        std::int64_t b = m_bottom.load(std::memory_order_relaxed);
+        std::int64_t t = m_top.load(std::memory_order_acquire);
+        ring *a = m_array.load(std::memory_order_relaxed);
+
+        if (b - t > static_cast<std::int64_t>(a->capacity) - 1)
+            a = grow(a, b, t);
+
+        a->put(b, item);
+        m_bottom.store(b + 1, std::memory_order_release);
     }
 
-    // 非阻塞获取（不等待生产者）
-    std::optional<task_type> try_get()
+    // 仅所有者线程调用
+    std::optional<T> pop()
     {
-        std::lock_guard<std::mutex> lock(m_get_mutex);
-        
-        if (consumer_empty())
+        std::int64_t b = m_bottom.load(std::memory_order_relaxed) - 1;
+        ring *a = m_array.load(std::memory_order_relaxed);
+        m_bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t t = m_top.load(std::memory_order_relaxed);
+
+        if (t > b)
         {
-            // 尝试交换，但不阻塞等待
-            if (!try_swap_queues())
+            m_bottom.store(b + 1, std::memory_order_relaxed);
+            return std::nullopt;
+        }
+
+        T item = a->get(b);
+        if (t == b)
+        {
+            // 最后一个元素，与窃取者竞争
+            bool won = m_top.compare_exchange_strong(t, t + 1,
+                std::memory_order_seq_cst, std::memory_order_relaxed);
+            m_bottom.store(b + 1, std::memory_order_relaxed);
+            if (!won)
                 return std::nullopt;
         }
-        
-        if (consumer_empty())
-            return std::nullopt;
-            
-        return take_from_consumer();
+        return item;
     }
 
-    // 获取队列大小（近似值）
-    size_t approximate_size() const
+    // 任意线程调用
+    std::optional<T> steal()
     {
-        std::lock_guard<std::mutex> lock1(m_put_mutex);
-        std::lock_guard<std::mutex> lock2(m_get_mutex);
-        return producer_size() + consumer_size();
+        std::int64_t t = m_top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t b = m_bottom.load(std::memory_order_acquire);
+
+        if (t >= b)
+            return std::nullopt;
+
+        ring *a = m_array.load(std::memory_order_acquire);
+        T item = a->get(t);
+        if (!m_top.compare_exchange_strong(t, t + 1,
+                std::memory_order_seq_cst, std::memory_order_relaxed))
+            return std::nullopt;
+        return item;
     }
 
-    // 清空所有队列
-    void clear()
+    [[nodiscard]] bool empty() const noexcept
     {
-        std::lock_guard<std::mutex> lock1(m_put_mutex);
-        std::lock_guard<std::mutex> lock2(m_get_mutex);
-        clear_producer();
-        clear_consumer();
+        return m_bottom.load(std::memory_order_relaxed) <= m_top.load(std::memory_order_relaxed);
     }
 
-    // 通知生产者有新空间（用于条件变量）
-    void notify_producer()
+private:
+    struct ring
     {
-        m_put_cv.notify_one();
-    }
+        explicit ring(std::size_t cap)
+            : capacity(cap), mask(cap - 1), buffer(new std::atomic<T>[cap]) {}
 
-    void notify_all_producers()
+        void put(std::int64_t i, T item) noexcept
+        {
+            buffer[static_cast<std::size_t>(i) & mask].store(item, std::memory_order_relaxed);
+        }
+
+        T get(std::int64_t i) const noexcept
+        {
+            return buffer[static_cast<std::size_t>(i) & mask].load(std::memory_order_relaxed);
+        }
+
+        std::size_t capacity;
+        std::size_t mask;
+        std::unique_ptr<std::atomic<T>[]> buffer;
+    };
+
+    ring *grow(ring *old, std::int64_t b, std::int64_t t)
     {
-        m_put_cv.notify_all();
+        // 旧数组可能仍被窃取者读取，保留到队列析构时释放
+        m_rings.push_back(std::make_unique<ring>(old->capacity * 2));
+        ring *a = m_rings.back().get();
+        for (std::int64_t i = t; i < b; ++i)
+            a->put(i, old->get(i));
+        m_array.store(a, std::memory_order_release);
+        return a;
     }
 
-    // 等待生产者队列有任务
-    template <typename Predicate>
-    void wait_for_task(std::unique_lock<std::mutex> &lock, Predicate pred)
+    alignas(64) std::atomic<std::int64_t> m_top{0};
+    alignas(64) std::atomic<std::int64_t> m_bottom{0};
+    std::atomic<ring *> m_array{nullptr};
+    std::vector<std::unique_ptr<ring>> m_rings;
+};
+
+// ============================================================================
+// 环形任务队列
+// ============================================================================
+
+// 容量按 2 的幂增长且不收缩，与双队列交换配合后稳定状态下入队/出队不分配内存
+template <typename T>
+class ring_queue
+{
+public:
+    ring_queue() = default;
+    ring_queue(ring_queue &&) noexcept = default;
+    ring_queue &operator=(ring_queue &&) noexcept = default;
+
+    void push(T &&item)
     {
-        m_get_cv.wait(lock, pred);
+        if (m_size == m_buffer.size())
+            grow();
+        m_buffer[(m_head + m_size) & (m_buffer.size() - 1)] = std::move(item);
+        ++m_size;
     }
 
-    template <typename Rep, typename Period, typename Predicate>
-    bool wait_for_task(std::unique_lock<std::mutex> &lock,
-                       const std::chrono::duration<Rep, Period> &timeout,
-                       Predicate pred)
+    T &front() { return m_buffer[m_head]; }
+    const T &front() const { return m_buffer[m_head]; }
+
+    void pop()
     {
-        return m_get_cv.wait_for(lock, timeout, pred);
+        m_buffer[m_head] = T();
+        m_head = (m_head + 1) & (m_buffer.size() - 1);
+        --m_size;
     }
 
-    void notify_consumer()
+    [[nodiscard]] bool empty() const noexcept { return m_size == 0; }
+    [[nodiscard]] std::size_t size() const noexcept { return m_size; }
+
+    void clear()
     {
-        m_get_cv.notify_one();
+        while (m_size > 0)
+            pop();
+        m_head = 0;
     }
 
-    void notify_all_consumers()
+private:
+    void grow()
     {
-        m_get_cv.notify_all();
+        std::vector<T> buffer(m_buffer.empty() ? 64 : m_buffer.size() * 2);
+        for (std::size_t i = 0; i < m_size; ++i)
+            buffer[i] = std::move(m_buffer[(m_head + i) & (m_buffer.size() - 1)]);
+        m_buffer = std::move(buffer);
+        m_head = 0;
     }
 
-    // 获取锁（用于外部条件变量同步）
-    std::mutex &put_mutex() { return m_put_mutex; }
-    std::mutex &get_mutex() { return m_get_mutex; }
+    std::vector<T> m_buffer;
+    std::size_t m_head = 0;
+    std::size_t m_size = 0;
+};
 
-private:
-    // 生产者端实现
-    void put_impl(task_type &&task)
+// ============================================================================
+// 分段优先级队列
+// ============================================================================
+
+inline unsigned highest_bit(unsigned mask) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return 31u - static_cast<unsigned>(__builtin_clz(mask));
+#else
+    unsigned bit = 0;
+    while (mask >>= 1)
+        ++bit;
+    return bit;
+#endif
+}
+
+inline unsigned lowest_bit(unsigned mask) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#else
+    unsigned bit = 0;
+    while ((mask & 1u) == 0)
     {
-        if constexpr (PriorityEnabled)
-        {
-            m_producer_queue.push(std::move(task));
-        }
-        else
-        {
-            m_producer_queue.push(std::move(task));
-        }
-        ++m_producer_size;
+        mask >>= 1;
+        ++bit;
     }
+    return bit;
+#endif
+}
 
-    void put_front_impl(task_type &&task)
+// 固定 8 个优先级段，每段一个 FIFO 环形队列，位图记录非空段：入队/出队 O(1)，
+// 高段先出，同一段内按入队顺序
+template <typename T>
+class banded_queue
+{
+public:
+    static constexpr unsigned band_count = 8;
+
+    // priority_t 的 [-128, 127] 均分为 8 段，数值越大段越高（默认优先级 0 位于第 4 段）
+    static constexpr unsigned band_of(priority_t priority) noexcept
     {
-        // 对于优先级队列，无法直接放入头部
-        // 这里简单处理：放入并依赖优先级
-        put_impl(std::move(task));
+        return static_cast<unsigned>(static_cast<int>(priority) + 128) >> 5;
     }
 
-    // 交换队列（核心优化：O(1) 交换而非逐个移动）
-    void swap_queues()
+    void push(T &&item)
     {
-        std::lock_guard<std::mutex> lock(m_put_mutex);
-        
-        // 交换生产者队列和消费者队列
-        std::swap(m_consumer_queue, m_producer_queue);
-        std::swap(m_consumer_size, m_producer_size);
-        
-        // 通知等待的生产者
-        if (m_producer_size == 0)
-            m_put_cv.notify_all();
+        unsigned band = band_of(item.priority);
+        m_bands[band].push(std::move(item));
+        m_mask |= 1u << band;
+        ++m_size;
+    }
+
+    // 最高非空段的队首
+    T &front() { return m_bands[highest_bit(m_mask)].front(); }
+
+    void pop() { pop_band(highest_bit(m_mask)); }
+
+    // 最低非空段的队首（该段中最早入队的任务）
+    T &lowest() { return m_bands[lowest_bit(m_mask)].front(); }
+
+    void pop_lowest() { pop_band(lowest_bit(m_mask)); }
+
+    [[nodiscard]] unsigned mask() const noexcept { return m_mask; }
+    [[nodiscard]] bool empty() const noexcept { return m_size == 0; }
+    [[nodiscard]] std::size_t size() const noexcept { return m_size; }
+
+    // 将 other 中的任务按段追加到本队列各段尾部，段内保持 FIFO；本段为空时直接交换缓冲区
+    void splice(banded_queue &other)
+    {
+        for (unsigned mask = other.m_mask; mask != 0; mask &= mask - 1)
+        {
+            unsigned band = lowest_bit(mask);
+            ring_queue<T> &src = other.m_bands[band];
+            ring_queue<T> &dst = m_bands[band];
+            if (dst.empty())
+            {
+                std::swap(dst, src);
+            }
+            else
+            {
+                while (!src.empty())
+                {
+                    dst.push(std::move(src.front()));
+                    src.pop();
+                }
+            }
+        }
+        m_mask |= other.m_mask;
+        m_size += other.m_size;
+        other.m_mask = 0;
+        other.m_size = 0;
+    }
+
+    void clear()
+    {
+        for (unsigned mask = m_mask; mask != 0; mask &= mask - 1)
+            m_bands[lowest_bit(mask)].clear();
+        m_mask = 0;
+        m_size = 0;
+    }
+
+private:
+    void pop_band(unsigned band)
+    {
+        m_bands[band].pop();
+        if (m_bands[band].empty())
+            m_mask &= ~(1u << band);
+        --m_size;
+    }
+
+    ring_queue<T> m_bands[band_count];
+    unsigned m_mask = 0;
+    std::size_t m_size = 0;
+};
+
+// ============================================================================
+// 工作线程放置
+// ============================================================================
+
+enum class cpu_affinity : uint8_t
+{
+    none,     // 不绑定，由操作系统调度
+    compact,  // 依次占满同一核心的 SMT 兄弟、同一 NUMA 节点，再进入下一个节点
+    spread,   // 轮流分布到各 NUMA 节点，节点内先占满物理核心再使用 SMT 兄弟
+    custom    // 第 i 个工作线程绑定到 cpu_sets[i % cpu_sets.size()]
+};
+
+// 工作线程的放置与调度参数，仅在 Linux 上生效，其余平台忽略；
+// 各项设置尽力而为，失败（如无权限设置实时调度）时线程照常运行
+struct thread_options
+{
+    cpu_affinity affinity = cpu_affinity::none;
+    std::vector<std::vector<int>> cpu_sets;   // custom 模式下每个工作线程可运行的 CPU 集合
+
+    std::string name_prefix;                  // 非空时线程名为 "<prefix>-<index>"（截断到 15 字节）
+
+    int sched_policy = -1;                    // SCHED_OTHER / SCHED_FIFO / SCHED_RR 等，-1 表示不修改
+    int sched_priority = 0;
+};
+
+namespace placement
+{
+
+struct cpu_info
+{
+    int cpu = 0;
+    int node = 0;
+    int package = 0;
+    int core = 0;
+};
+
+// 解析 "0-3,8,10-11" 形式的 CPU/节点列表
+inline std::vector<int> parse_cpu_list(const std::string &text)
+{
+    std::vector<int> result;
+    std::size_t pos = 0;
+    while (pos < text.size())
+    {
+        std::size_t end = text.find(',', pos);
+        if (end == std::string::npos)
+            end = text.size();
+        std::string item = text.substr(pos, end - pos);
+        pos = end + 1;
+
+        std::size_t dash = item.find('-');
+        try
+        {
+            int first = std::stoi(item.substr(0, dash));
+            int last = dash == std::string::npos ? first : std::stoi(item.substr(dash + 1));
+            for (int i = first; i <= last; ++i)
+                result.push_back(i);
+        }
+        catch (...)
+        {
+            // 忽略无法解析的项（如末尾换行）
+        }
+    }
+    return result;
+}
+
+inline std::string read_sysfs(const std::string &path)
+{
+    std::ifstream in(path);
+    std::string line;
+    std::getline(in, line);
+    return line;
+}
+
+inline int read_sysfs_int(const std::string &path, int fallback)
+{
+    try
+    {
+        return std::stoi(read_sysfs(path));
+    }
+    catch (...)
+    {
+        return fallback;
+    }
+}
+
+// 当前进程允许使用的 CPU 及其拓扑（sysfs 不可用时节点/封装/核心退化为 CPU 编号）
+inline std::vector<cpu_info> cpu_topology()
+{
+    std::vector<cpu_info> cpus;
+#if defined(__linux__)
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+        return cpus;
+
+    const std::string cpu_dir = "/sys/devices/system/cpu/cpu";
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+    {
+        if (!CPU_ISSET(cpu, &allowed))
+            continue;
+        cpu_info info;
+        info.cpu = cpu;
+        info.package = read_sysfs_int(cpu_dir + std::to_string(cpu) + "/topology/physical_package_id", 0);
+        info.core = read_sysfs_int(cpu_dir + std::to_string(cpu) + "/topology/core_id", cpu);
+        cpus.push_back(info);
+    }
+
+    const std::string node_dir = "/sys/devices/system/node/node";
+    for (int node : parse_cpu_list(read_sysfs("/sys/devices/system/node/online")))
+    {
+        for (int cpu : parse_cpu_list(read_sysfs(node_dir + std::to_string(node) + "/cpulist")))
+        {
+            for (cpu_info &info : cpus)
+            {
+                if (info.cpu == cpu)
+                    info.node = node;
+            }
+        }
+    }
+#endif
+    return cpus;
+}
+
+// 按策略排列 CPU，第 i 个工作线程绑定到结果中的第 i % size 项
+inline std::vector<std::vector<int>> plan(const thread_options &options)
+{
+    std::vector<std::vector<int>> result;
+    if (options.affinity == cpu_affinity::custom)
+    {
+        for (const auto &set : options.cpu_sets)
+        {
+            if (!set.empty())
+                result.push_back(set);
+        }
+        return result;
+    }
+    if (options.affinity == cpu_affinity::none)
+        return result;
+
+    std::vector<cpu_info> cpus = cpu_topology();
+    auto by_location = [](const cpu_info &a, const cpu_info &b)
+    {
+        if (a.node != b.node) return a.node < b.node;
+        if (a.package != b.package) return a.package < b.package;
+        if (a.core != b.core) return a.core < b.core;
+        return a.cpu < b.cpu;
+    };
+    std::sort(cpus.begin(), cpus.end(), by_location);
+
+    if (options.affinity == cpu_affinity::compact)
+    {
+        for (const cpu_info &info : cpus)
+            result.push_back({info.cpu});
+        return result;
+    }
+
+    // spread：每个节点内按“第几个 SMT 兄弟”分层，先取各物理核心的第一个逻辑 CPU
+    std::vector<std::vector<std::pair<int, int>>> nodes;   // (兄弟序号, cpu)
+    for (std::size_t i = 0; i < cpus.size(); ++i)
+    {
+        bool new_node = i == 0 || cpus[i].node != cpus[i - 1].node;
+        if (new_node)
+            nodes.emplace_back();
+        int rank = 0;
+        if (!new_node && cpus[i].package == cpus[i - 1].package && cpus[i].core == cpus[i - 1].core)
+            rank = nodes.back().back().first + 1;
+        nodes.back().emplace_back(rank, cpus[i].cpu);
+    }
+    for (auto &node : nodes)
+        std::stable_sort(node.begin(), node.end(),
+                         [](const auto &a, const auto &b) { return a.first < b.first; });
+
+    for (std::size_t round = 0; result.size() < cpus.size(); ++round)
+    {
+        for (auto &node : nodes)
+        {
+            if (round < node.size())
+                result.push_back({node[round].second});
+        }
+    }
+    return result;
+}
+
+// 对 handle 指向的线程应用放置参数，cpu_plan 为 plan() 的结果
+template <typename NativeHandle>
+void apply(NativeHandle handle, std::size_t index, const thread_options &options,
+           const std::vector<std::vector<int>> &cpu_plan)
+{
+#if defined(__linux__)
+    if (!cpu_plan.empty())
+    {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int cpu : cpu_plan[index % cpu_plan.size()])
+        {
+            if (cpu >= 0 && cpu < CPU_SETSIZE)
+                CPU_SET(cpu, &set);
+        }
+        pthread_setaffinity_np(handle, sizeof(set), &set);
+    }
+
+    if (!options.name_prefix.empty())
+    {
+        std::string name = options.name_prefix + "-" + std::to_string(index);
+        if (name.size() > 15)
+            name.resize(15);
+        pthread_setname_np(handle, name.c_str());
+    }
+
+    if (options.sched_policy >= 0)
+    {
+        sched_param param{};
+        param.sched_priority = options.sched_priority;
+        pthread_setschedparam(handle, options.sched_policy, &param);
+    }
+#else
+    (void)handle;
+    (void)index;
+    (void)options;
+    (void)cpu_plan;
+#endif
+}
+
+} // namespace placement
+
+// ============================================================================
+// 空闲自旋
+// ============================================================================
+
+// 空闲线程休眠前自旋等待的时间上限（纳秒，单核机器默认 0），可通过 set_idle_spin() 在运行时修改
+#ifndef THREADPOOL_IDLE_SPIN_NS
+#define THREADPOOL_IDLE_SPIN_NS 50000
+#endif
+
+inline void cpu_relax() noexcept
+{
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+// 每个工作线程的自旋预算：按“开始空闲到拿到任务”间隔的指数滑动平均调整
+// 任务间隔短于上限时自旋约两倍平均间隔，否则只做短暂探测后休眠
+class idle_spin_state
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    void on_idle() noexcept
+    {
+        if (!m_idle)
+        {
+            m_idle = true;
+            m_idle_since = clock::now();
+        }
+    }
+
+    // 返回本次是否从空闲状态恢复
+    bool on_task() noexcept
+    {
+        if (!m_idle)
+            return false;
+        m_idle = false;
+        auto gap = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - m_idle_since);
+        m_avg_gap += (gap - m_avg_gap) / 8;
+        return true;
+    }
+
+    [[nodiscard]] std::chrono::nanoseconds budget(std::chrono::nanoseconds limit) const noexcept
+    {
+        if (limit.count() <= 0)
+            return std::chrono::nanoseconds(0);
+        std::chrono::nanoseconds probe = limit / 16;
+        if (m_avg_gap > limit)
+            return probe;
+        return std::min(limit, std::max(probe, m_avg_gap * 2));
+    }
+
+private:
+    std::chrono::nanoseconds m_avg_gap{0};
+    clock::time_point m_idle_since{};
+    bool m_idle = false;
+};
+
+// ============================================================================
+// 运行指标（tp_flag::metrics）
+// ============================================================================
+
+// HDR 风格的对数-线性直方图快照：每个 2 的幂区间再均分为 8 个子桶，相对误差不超过 12.5%
+class latency_histogram
+{
+public:
+    static constexpr std::size_t sub_buckets = 8;
+    static constexpr std::size_t bucket_count = 64 * sub_buckets;
+    static constexpr std::uint64_t max_value = std::uint64_t(1) << 62;
+
+    static std::size_t index_of(std::uint64_t value) noexcept
+    {
+        if (value < sub_buckets)
+            return static_cast<std::size_t>(value);
+        if (value > max_value)
+            value = max_value;
+        unsigned exp = highest_bit64(value);
+        std::size_t sub = static_cast<std::size_t>(value >> (exp - 3)) & (sub_buckets - 1);
+        return (exp - 2) * sub_buckets + sub;
+    }
+
+    // 桶内最大值（百分位数按桶上界报告，偏保守）
+    static std::uint64_t upper_bound_of(std::size_t index) noexcept
+    {
+        if (index < sub_buckets)
+            return index;
+        unsigned exp = static_cast<unsigned>(index / sub_buckets) + 2;
+        std::uint64_t sub = index % sub_buckets;
+        return ((sub_buckets + sub + 1) << (exp - 3)) - 1;
+    }
+
+    [[nodiscard]] std::uint64_t count() const noexcept { return m_count; }
+    [[nodiscard]] std::uint64_t max() const noexcept { return m_max; }
+
+    [[nodiscard]] double mean() const noexcept
+    {
+        return m_count ? static_cast<double>(m_sum) / static_cast<double>(m_count) : 0.0;
+    }
+
+    // q 取 [0, 1]，如 0.99 表示 p99；无样本时返回 0
+    [[nodiscard]] std::uint64_t percentile(double q) const noexcept
+    {
+        if (m_count == 0)
+            return 0;
+        std::uint64_t rank = static_cast<std::uint64_t>(q * static_cast<double>(m_count - 1)) + 1;
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < bucket_count; ++i)
+        {
+            seen += m_buckets[i];
+            if (seen >= rank)
+                return std::min(upper_bound_of(i), m_max);
+        }
+        return m_max;
+    }
+
+    [[nodiscard]] const std::array<std::uint64_t, bucket_count> &buckets() const noexcept { return m_buckets; }
+
+    void merge(const latency_histogram &other) noexcept
+    {
+        for (std::size_t i = 0; i < bucket_count; ++i)
+            m_buckets[i] += other.m_buckets[i];
+        m_count += other.m_count;
+        m_sum += other.m_sum;
+        m_max = std::max(m_max, other.m_max);
+    }
+
+private:
+    friend class atomic_latency_histogram;
+
+    static unsigned highest_bit64(std::uint64_t value) noexcept
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return 63u - static_cast<unsigned>(__builtin_clzll(value));
+#else
+        unsigned bit = 0;
+        while (value >>= 1)
+            ++bit;
+        return bit;
+#endif
+    }
+
+    std::array<std::uint64_t, bucket_count> m_buckets{};
+    std::uint64_t m_count = 0;
+    std::uint64_t m_sum = 0;
+    std::uint64_t m_max = 0;
+};
+
+// 工作线程写、快照线程读的直方图，全部使用 relaxed 原子操作
+class atomic_latency_histogram
+{
+public:
+    void record(std::int64_t ns) noexcept
+    {
+        std::uint64_t value = ns > 0 ? static_cast<std::uint64_t>(ns) : 0;
+        m_buckets[latency_histogram::index_of(value)].fetch_add(1, std::memory_order_relaxed);
+        m_count.fetch_add(1, std::memory_order_relaxed);
+        m_sum.fetch_add(value, std::memory_order_relaxed);
+        std::uint64_t prev = m_max.load(std::memory_order_relaxed);
+        while (value > prev && !m_max.compare_exchange_weak(prev, value, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    void snapshot_into(latency_histogram &out) const noexcept
+    {
+        latency_histogram h;
+        for (std::size_t i = 0; i < latency_histogram::bucket_count; ++i)
+            h.m_buckets[i] = m_buckets[i].load(std::memory_order_relaxed);
+        h.m_count = m_count.load(std::memory_order_relaxed);
+        h.m_sum = m_sum.load(std::memory_order_relaxed);
+        h.m_max = m_max.load(std::memory_order_relaxed);
+        out.merge(h);
+    }
+
+private:
+    std::array<std::atomic<std::uint64_t>, latency_histogram::bucket_count> m_buckets{};
+    std::atomic<std::uint64_t> m_count{0};
+    std::atomic<std::uint64_t> m_sum{0};
+    std::atomic<std::uint64_t> m_max{0};
+};
+
+// 单个工作线程的实时计数（线程退出后保留，用于累计统计）
+struct worker_metrics
+{
+    explicit worker_metrics(std::size_t i, std::int64_t start) noexcept
+        : index(i), start_ns(start) {}
+
+    std::size_t index;
+    std::int64_t start_ns;
+    std::atomic<std::int64_t> end_ns{0};       // 0 表示仍在运行
+    std::atomic<std::uint64_t> busy_ns{0};
+    std::atomic<std::uint64_t> tasks{0};
+    std::atomic<std::uint64_t> steals{0};
+    atomic_latency_histogram queue_wait;
+    atomic_latency_histogram run_time;
+};
+
+struct worker_metrics_snapshot
+{
+    std::size_t index = 0;
+    bool running = false;
+    std::uint64_t busy_ns = 0;
+    std::uint64_t idle_ns = 0;
+    std::uint64_t tasks = 0;
+    std::uint64_t steals = 0;
+    double busy_ratio = 0.0;       // busy / (busy + idle)
+};
+
+struct metrics_snapshot
+{
+    latency_histogram queue_wait;  // 入队到开始执行（纳秒）
+    latency_histogram run_time;    // 执行耗时（纳秒）
+    std::vector<worker_metrics_snapshot> workers;
+    std::uint64_t tasks = 0;
+    std::uint64_t steals = 0;      // work_stealing 模式下从其他线程窃取的任务数
+    std::uint64_t swaps = 0;       // 全局队列生产者/消费者两端交换（含优先级段并入）次数
+    std::uint64_t caller_ran = 0;  // caller_runs 策略下在提交线程执行的任务数（已计入直方图）
+    double busy_ratio = 0.0;       // 所有工作线程合计
+};
+
+// ============================================================================
+// 事件计数器（空闲线程休眠/唤醒）
+// ============================================================================
+
+// 等待方：prepare_wait() 登记 -> 复查条件 -> 不满足则 commit_wait()，满足则 cancel_wait()
+// 通知方：先发布条件再 notify_*()；没有等待者时只有一次原子读，不加锁也不进入内核
+class event_count
+{
+public:
+    using key_type = std::uint32_t;
+
+    event_count() = default;
+    event_count(const event_count &) = delete;
+    event_count &operator=(const event_count &) = delete;
+
+    key_type prepare_wait() noexcept
+    {
+        m_waiters.fetch_add(1, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return m_epoch.load(std::memory_order_acquire);
+    }
+
+    void cancel_wait() noexcept
+    {
+        m_waiters.fetch_sub(1, std::memory_order_seq_cst);
+    }
+
+    void commit_wait(key_type key) noexcept
+    {
+#if defined(__linux__)
+        while (m_epoch.load(std::memory_order_acquire) == key)
+        {
+            syscall(SYS_futex, reinterpret_cast<std::uint32_t *>(&m_epoch),
+                    FUTEX_WAIT_PRIVATE, key, nullptr, nullptr, 0);
+        }
+#else
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this, key] { return m_epoch.load(std::memory_order_acquire) != key; });
+        }
+#endif
+        m_waiters.fetch_sub(1, std::memory_order_seq_cst);
+    }
+
+    // 带超时的 commit_wait，超时返回 false
+    template <typename Clock, typename Duration>
+    bool commit_wait_until(key_type key, const std::chrono::time_point<Clock, Duration> &deadline) noexcept
+    {
+        bool signaled = true;
+#if defined(__linux__)
+        while (m_epoch.load(std::memory_order_acquire) == key)
+        {
+            auto now = Clock::now();
+            if (now >= deadline)
+            {
+                signaled = false;
+                break;
+            }
+            auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - now).count();
+            timespec ts{static_cast<time_t>(ns / 1000000000), static_cast<long>(ns % 1000000000)};
+            syscall(SYS_futex, reinterpret_cast<std::uint32_t *>(&m_epoch),
+                    FUTEX_WAIT_PRIVATE, key, &ts, nullptr, 0);
+        }
+#else
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            signaled = m_cv.wait_until(lock, deadline, [this, key] {
+                return m_epoch.load(std::memory_order_acquire) != key;
+            });
+        }
+#endif
+        m_waiters.fetch_sub(1, std::memory_order_seq_cst);
+        return signaled;
+    }
+
+    void notify_one() noexcept { notify(1); }
+    void notify_all() noexcept { notify(INT_MAX); }
+
+    // 至多唤醒 count 个等待者（不足 count 个时全部唤醒）
+    void notify_n(std::size_t count) noexcept
+    {
+        if (count > 0)
+            notify(count >= static_cast<std::size_t>(INT_MAX) ? INT_MAX : static_cast<int>(count));
+    }
+
+    [[nodiscard]] bool has_waiters() const noexcept
+    {
+        return m_waiters.load(std::memory_order_acquire) != 0;
+    }
+
+private:
+    void notify(int count) noexcept
+    {
+        // 与 prepare_wait 中的屏障配对：要么通知方看到等待者，要么等待方复查时看到条件
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_waiters.load(std::memory_order_seq_cst) == 0)
+            return;
+
+        m_epoch.fetch_add(1, std::memory_order_seq_cst);
+#if defined(__linux__)
+        syscall(SYS_futex, reinterpret_cast<std::uint32_t *>(&m_epoch),
+                FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+#else
+        { std::lock_guard<std::mutex> lock(m_mutex); }
+        if (static_cast<std::uint32_t>(count) >= m_waiters.load(std::memory_order_relaxed))
+        {
+            m_cv.notify_all();
+        }
+        else
+        {
+            for (int i = 0; i < count; ++i)
+                m_cv.notify_one();
+        }
+#endif
+    }
+
+    static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t),
+                  "futex requires a plain 32-bit word");
+
+    alignas(64) std::atomic<std::uint32_t> m_epoch{0};
+    std::atomic<std::uint32_t> m_waiters{0};
+#if !defined(__linux__)
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+#endif
+};
+
+// ============================================================================
+// task_group 辅助类（submit_blocks / submit_loop 的结果）
+// ============================================================================
+
+// 同一批块共享一个状态：结果预分配在连续数组中，完成情况只用一个原子计数跟踪
+// 线程池中的任务只负责“领取未执行的块”，等待方也通过同一计数领取块并就地执行
+template <typename R>
+struct task_group_state
+{
+    using slot_type = std::optional<std::conditional_t<std::is_void_v<R>, char, R>>;
+    using body_type = move_only_function<void(task_group_state &, std::size_t)>;
+
+    task_group_state(std::size_t n, body_type &&fn)
+        : count(n), remaining(n), body(std::move(fn))
+    {
+        if constexpr (!std::is_void_v<R>)
+            results.resize(n);
+    }
+
+    // 领取并执行一个块，没有剩余块时返回 false
+    bool run_one()
+    {
+        std::size_t i = next.fetch_add(1, std::memory_order_relaxed);
+        if (i >= count)
+            return false;
+
+        try
+        {
+            body(*this, i);
+        }
+        catch (...)
+        {
+            if (!failed.exchange(true, std::memory_order_acq_rel))
+                error = std::current_exception();
+        }
+
+        if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            done.notify_all();
+        return true;
+    }
+
+    [[nodiscard]] bool finished() const noexcept
+    {
+        return remaining.load(std::memory_order_acquire) == 0;
+    }
+
+    std::size_t count;
+    alignas(64) std::atomic<std::size_t> next{0};
+    alignas(64) std::atomic<std::size_t> remaining;
+    std::vector<slot_type> results;
+    std::atomic<bool> failed{false};
+    std::exception_ptr error;
+    event_count done;
+    body_type body;
+};
+
+template <typename R>
+class task_group
+{
+public:
+    task_group() = default;
+
+    explicit task_group(std::shared_ptr<task_group_state<R>> state)
+        : m_state(std::move(state)) {}
+
+    [[nodiscard]] bool valid() const noexcept { return m_state != nullptr; }
+
+    [[nodiscard]] std::size_t size() const noexcept
+    {
+        return m_state ? m_state->count : 0;
+    }
+
+    [[nodiscard]] std::size_t ready_count() const noexcept
+    {
+        return m_state ? m_state->count - m_state->remaining.load(std::memory_order_acquire) : 0;
+    }
+
+    [[nodiscard]] bool ready() const noexcept
+    {
+        return !m_state || m_state->finished();
+    }
+
+    // 先协助执行尚未被领取的块，再等待其他线程上正在执行的块
+    void wait() const
+    {
+        if (!m_state)
+            return;
+        while (m_state->run_one())
+        {
+        }
+        while (!m_state->finished())
+        {
+            event_count::key_type key = m_state->done.prepare_wait();
+            if (m_state->finished())
+            {
+                m_state->done.cancel_wait();
+                break;
+            }
+            m_state->done.commit_wait(key);
+        }
+    }
+
+    template <typename Rep, typename Period>
+    bool wait_for(const std::chrono::duration<Rep, Period> &duration) const
+    {
+        if (!m_state)
+            return true;
+        auto deadline = std::chrono::steady_clock::now() + duration;
+        while (std::chrono::steady_clock::now() < deadline && m_state->run_one())
+        {
+        }
+        while (!m_state->finished())
+        {
+            event_count::key_type key = m_state->done.prepare_wait();
+            if (m_state->finished())
+            {
+                m_state->done.cancel_wait();
+                break;
+            }
+            if (!m_state->done.commit_wait_until(key, deadline))
+                return m_state->finished();
+        }
+        return true;
+    }
+
+    // 任一块抛出异常时重新抛出第一个异常；结果只能取一次
+    [[nodiscard]] std::conditional_t<std::is_void_v<R>, void, std::vector<R>> get()
+    {
+        wait();
+        if (m_state && m_state->failed.load(std::memory_order_acquire))
+            std::rethrow_exception(m_state->error);
+
+        if constexpr (!std::is_void_v<R>)
+        {
+            std::vector<R> values;
+            if (!m_state)
+                return values;
+            values.reserve(m_state->count);
+            for (auto &slot : m_state->results)
+                values.push_back(std::move(*slot));
+            return values;
+        }
+    }
+
+private:
+    std::shared_ptr<task_group_state<R>> m_state;
+};
+
+// ============================================================================
+// 定时任务
+// ============================================================================
+
+struct timer_state
+{
+    move_only_function<void()> task;
+    std::int64_t period_ns = 0;     // 0 表示一次性定时
+    priority_t priority = 0;
+    std::atomic<bool> cancelled{false};
+};
+
+// schedule_after/schedule_at/schedule_every 的返回值，可在任意线程取消；
+// 句柄不持有线程池，丢弃句柄不影响定时任务
+class timer_handle
+{
+public:
+    timer_handle() = default;
+    explicit timer_handle(std::shared_ptr<timer_state> state) : m_state(std::move(state)) {}
+
+    [[nodiscard]] bool valid() const noexcept { return m_state != nullptr; }
+
+    // 取消后不再触发；已开始执行的一次不受影响。返回本次调用是否由未取消变为取消
+    bool cancel() noexcept
+    {
+        return m_state && !m_state->cancelled.exchange(true, std::memory_order_acq_rel);
+    }
+
+    [[nodiscard]] bool cancelled() const noexcept
+    {
+        return m_state && m_state->cancelled.load(std::memory_order_acquire);
+    }
+
+private:
+    std::shared_ptr<timer_state> m_state;
+};
+
+// ============================================================================
+// 双队列任务管理器（借鉴 C 版本的 __taskqueue_swap 设计）
+// ============================================================================
+
+template <bool PriorityEnabled, bool MetricsEnabled = false>
+class dual_task_queue
+{
+    using task_type = task_wrapper<PriorityEnabled, MetricsEnabled>;
+    using queue_type = std::conditional_t<
+        PriorityEnabled,
+        banded_queue<task_type>,
+        ring_queue<task_type>>;
+
+public:
+    dual_task_queue() = default;
+
+    // ------------------------------------------------------------------------
+    // 容量控制：put/put_range/put_front 不检查容量，受限入队使用下面的接口
+    // ------------------------------------------------------------------------
+
+    // 设置容量上限（0 表示不限），放宽时唤醒阻塞的生产者
+    void set_capacity(size_t capacity)
+    {
+        std::lock_guard<std::mutex> lock(m_put_mutex);
+        m_capacity.store(capacity, std::memory_order_relaxed);
+        m_put_cv.notify_all();
+    }
+
+    [[nodiscard]] size_t capacity() const noexcept { return m_capacity.load(std::memory_order_relaxed); }
+    [[nodiscard]] size_t size() const noexcept { return m_size.load(std::memory_order_acquire); }
+    [[nodiscard]] size_t high_water() const noexcept { return m_high_water.load(std::memory_order_relaxed); }
+
+    // 两端交换次数（仅 MetricsEnabled 时统计）
+    [[nodiscard]] std::uint64_t swap_count() const noexcept
+    {
+        if constexpr (MetricsEnabled)
+            return m_swaps.load(std::memory_order_relaxed);
+        else
+            return 0;
+    }
+
+    // 有空位时放入，task 仅在成功时被移走
+    bool try_put(task_type &task)
+    {
+        std::lock_guard<std::mutex> lock(m_put_mutex);
+        if (full_locked())
+            return false;
+        put_impl(std::move(task));
+        return true;
+    }
+
+    // 队列满时阻塞等待空位，超过 deadline 或 abort() 为真时返回 false；blocked 记录是否等待过
+    template <typename Abort>
+    bool put_until(task_type &task, std::chrono::steady_clock::time_point deadline,
+                   bool &blocked, Abort &&abort)
+    {
+        std::unique_lock<std::mutex> lock(m_put_mutex);
+        while (full_locked())
+        {
+            if (abort())
+                return false;
+            blocked = true;
+            // 先登记再复查容量，与消费者“先减计数再检查等待者”配对，避免丢失唤醒
+            m_blocked_producers.fetch_add(1, std::memory_order_seq_cst);
+            bool timed_out = false;
+            if (full_locked())
+            {
+                if (deadline == std::chrono::steady_clock::time_point::max())
+                    m_put_cv.wait(lock);
+                else
+                    timed_out = m_put_cv.wait_until(lock, deadline) == std::cv_status::timeout;
+            }
+            m_blocked_producers.fetch_sub(1, std::memory_order_relaxed);
+            if (timed_out && full_locked())
+                return false;
+        }
+        put_impl(std::move(task));
+        return true;
+    }
+
+    // 队列满时丢弃最旧的任务为新任务腾出空间；优先级模式下丢弃最低非空段中最早的任务，
+    // 新任务所在段低于所有已排队任务时不入队。返回新任务是否入队，被丢弃的任务放入 dropped
+    bool put_drop_oldest(task_type &task, std::optional<task_type> &dropped)
+    {
+        std::lock_guard<std::mutex> lock1(m_get_mutex);
+        std::lock_guard<std::mutex> lock2(m_put_mutex);
+        if (full_locked())
+        {
+            if constexpr (PriorityEnabled)
+            {
+                unsigned consumer_mask = m_consumer_queue.mask();
+                unsigned producer_mask = m_producer_queue.mask();
+                if ((consumer_mask | producer_mask) == 0)
+                    return false;
+                unsigned band = lowest_bit(consumer_mask | producer_mask);
+                if (queue_type::band_of(task.priority) < band)
+                    return false;
+
+                // 同一段内消费者队列中的任务早于生产者队列
+                bool from_consumer = ((consumer_mask >> band) & 1u) != 0;
+                queue_type &victim = from_consumer ? m_consumer_queue : m_producer_queue;
+                dropped.emplace(std::move(victim.lowest()));
+                victim.pop_lowest();
+                --(from_consumer ? m_consumer_size : m_producer_size);
+                publish_producer_mask();
+            }
+            else
+            {
+                // 消费者队列中的任务总是早于生产者队列
+                queue_type &victim = m_consumer_size > 0 ? m_consumer_queue : m_producer_queue;
+                size_t &victim_size = m_consumer_size > 0 ? m_consumer_size : m_producer_size;
+                if (victim_size == 0)
+                    return false;
+                dropped.emplace(std::move(victim.front()));
+                victim.pop();
+                --victim_size;
+            }
+            m_size.fetch_sub(1, std::memory_order_relaxed);
+        }
+        put_impl(std::move(task));
+        return true;
+    }
+
+    // 生产者端：放入任务
+    void put(task_type &&task)
+    {
+        std::lock_guard<std::mutex> lock(m_put_mutex);
+        put_impl(std::move(task));
+    }
+
+    // 生产者端：批量放入任务，整批只加一次锁
+    template <typename Iterator>
+    void put_range(Iterator first, Iterator last)
+    {
+        std::lock_guard<std::mutex> lock(m_put_mutex);
+        for (; first != last; ++first)
+            put_impl(std::move(*first));
+    }
+
+    // 生产者端：放入任务到头部（用于特殊任务）
+    void put_front(task_type &&task)
+    {
+        std::lock_guard<std::mutex> lock(m_put_mutex);
+        put_front_impl(std::move(task));
+    }
+
+    // 消费者端：获取任务（批量交换后从消费者队列获取）
+    std::optional<task_type> get()
+    {
+        std::lock_guard<std::mutex> lock(m_get_mutex);
+
+        if constexpr (PriorityEnabled)
+            promote_producer_bands(false);
+        
+        // 如果消费者队列为空，尝试与生产者队列交换
+        if (consumer_empty())
+        {
+            swap_queues();
+        }
+        
+        if (consumer_empty())
+            return std::nullopt;
+            
+        return take_from_consumer();
+    }
+
+    // 非阻塞获取（不等待生产者）
+    std::optional<task_type> try_get()
+    {
+        std::lock_guard<std::mutex> lock(m_get_mutex);
+
+        if constexpr (PriorityEnabled)
+            promote_producer_bands(true);
+
+        if (consumer_empty())
+        {
+            // 尝试交换，但不阻塞等待
+            if (!try_swap_queues())
+                return std::nullopt;
+        }
+        
+        if (consumer_empty())
+            return std::nullopt;
+            
+        return take_from_consumer();
+    }
+
+    // 获取队列大小（近似值）
+    // 加锁顺序与 swap_queues 一致：先 get 后 put
+    size_t approximate_size() const
+    {
+        std::lock_guard<std::mutex> lock1(m_get_mutex);
+        std::lock_guard<std::mutex> lock2(m_put_mutex);
+        return producer_size() + consumer_size();
+    }
+
+    // 清空所有队列，返回丢弃的任务数；任务在锁外析构（析构时可能恢复协程并再次提交），
+    // on_cleared(丢弃数) 在析构前调用
+    size_t clear()
+    {
+        return clear([](size_t) {});
+    }
+
+    template <typename F>
+    size_t clear(F &&on_cleared)
+    {
+        queue_type producer;
+        queue_type consumer;
+        size_t count;
+        {
+            std::lock_guard<std::mutex> lock1(m_get_mutex);
+            std::lock_guard<std::mutex> lock2(m_put_mutex);
+            count = producer_size() + consumer_size();
+            std::swap(producer, m_producer_queue);
+            std::swap(consumer, m_consumer_queue);
+            clear_producer();
+            clear_consumer();
+            m_size.store(0, std::memory_order_seq_cst);
+            m_put_cv.notify_all();
+        }
+        on_cleared(count);
+        return count;
+    }
+
+    // 通知生产者有新空间（用于条件变量）
+    void notify_producer()
+    {
+        m_put_cv.notify_one();
+    }
+
+    // 加锁后通知，保证正在检查条件的生产者不会错过（如线程池停止时）
+    void notify_all_producers()
+    {
+        std::lock_guard<std::mutex> lock(m_put_mutex);
+        m_put_cv.notify_all();
+    }
+
+    // 消费者的休眠/唤醒由线程池的 event_count 负责，队列本身不再持有消费者条件变量
+
+    // 获取锁（用于外部条件变量同步）
+    std::mutex &put_mutex() { return m_put_mutex; }
+    std::mutex &get_mutex() { return m_get_mutex; }
+
+private:
+    // 生产者端实现
+    void put_impl(task_type &&task)
+    {
+        if constexpr (PriorityEnabled)
+        {
+            m_producer_queue.push(std::move(task));
+        }
+        else
+        {
+            m_producer_queue.push(std::move(task));
+        }
+        ++m_producer_size;
+        publish_producer_mask();
+
+        size_t size = m_size.fetch_add(1, std::memory_order_seq_cst) + 1;
+        if (size > m_high_water.load(std::memory_order_relaxed))
+            m_high_water.store(size, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] bool full_locked() const noexcept
+    {
+        size_t capacity = m_capacity.load(std::memory_order_relaxed);
+        return capacity != 0 && m_size.load(std::memory_order_seq_cst) >= capacity;
+    }
+
+    // 消费者取走任务后释放一个空位（调用方持有 m_get_mutex）
+    void release_slot()
+    {
+        m_size.fetch_sub(1, std::memory_order_seq_cst);
+        if (m_blocked_producers.load(std::memory_order_seq_cst) > 0)
+        {
+            std::lock_guard<std::mutex> lock(m_put_mutex);
+            m_put_cv.notify_one();
+        }
+    }
+
+    void put_front_impl(task_type &&task)
+    {
+        // 对于优先级队列，无法直接放入头部
+        // 这里简单处理：放入并依赖优先级
+        put_impl(std::move(task));
+    }
+
+    // 只统计真正搬入任务的交换
+    void count_swap()
+    {
+        if constexpr (MetricsEnabled)
+        {
+            if (m_consumer_size > 0)
+                m_swaps.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // 优先级模式：生产者队列的非空段位图，消费者无需加 put 锁即可判断是否有更高优先级任务
+    void publish_producer_mask()
+    {
+        if constexpr (PriorityEnabled)
+            m_producer_mask.store(m_producer_queue.mask(), std::memory_order_release);
+    }
+
+    // 生产者队列中有高于消费者队列最高段的任务时，将生产者队列并入消费者队列，
+    // 保证出队顺序跨两端严格按优先级；每个任务至多被搬移一次
+    void promote_producer_bands(bool try_only)
+    {
+        if constexpr (PriorityEnabled)
+        {
+            unsigned producer_mask = m_producer_mask.load(std::memory_order_acquire);
+            if (producer_mask == 0 || consumer_empty() ||
+                highest_bit(producer_mask) <= highest_bit(m_consumer_queue.mask()))
+                return;
+
+            std::unique_lock<std::mutex> lock(m_put_mutex, std::defer_lock);
+            if (try_only)
+            {
+                if (!lock.try_lock())
+                    return;
+            }
+            else
+            {
+                lock.lock();
+            }
+            m_consumer_queue.splice(m_producer_queue);
+            m_consumer_size += m_producer_size;
+            m_producer_size = 0;
+            publish_producer_mask();
+            count_swap();
+        }
+        else
+        {
+            (void)try_only;
+        }
+    }
+
+    // 交换队列（核心优化：O(1) 交换而非逐个移动）
+    void swap_queues()
+    {
+        std::lock_guard<std::mutex> lock(m_put_mutex);
+        
+        // 交换生产者队列和消费者队列
+        std::swap(m_consumer_queue, m_producer_queue);
+        std::swap(m_consumer_size, m_producer_size);
+        publish_producer_mask();
+        count_swap();
+        
+        // 通知等待的生产者
+        if (m_producer_size == 0)
+            m_put_cv.notify_all();
     }
 
     bool try_swap_queues()
@@ -552,6 +2065,8 @@ private:
             
         std::swap(m_consumer_queue, m_producer_queue);
         std::swap(m_consumer_size, m_producer_size);
+        publish_producer_mask();
+        count_swap();
         
         if (m_producer_size == 0)
             m_put_cv.notify_all();
@@ -564,9 +2079,10 @@ private:
         if (consumer_empty())
             return std::nullopt;
             
-        task_type task = std::move(const_cast<task_type&>(top_consumer()));
-        pop_consumer();
+        task_type task = std::move(m_consumer_queue.front());
+        m_consumer_queue.pop();
         --m_consumer_size;
+        release_slot();
         return task;
     }
 
@@ -575,37 +2091,16 @@ private:
     size_t consumer_size() const { return m_consumer_size; }
     size_t producer_size() const { return m_producer_size; }
 
-    const task_type& top_consumer() const
-    {
-        if constexpr (PriorityEnabled)
-            return m_consumer_queue.top();
-        else
-            return m_consumer_queue.front();
-    }
-
-    void pop_consumer()
-    {
-        if constexpr (PriorityEnabled)
-            m_consumer_queue.pop();
-        else
-            m_consumer_queue.pop();
-    }
-
     void clear_producer()
     {
-        if constexpr (PriorityEnabled)
-            m_producer_queue = std::priority_queue<task_type>();
-        else
-            m_producer_queue = std::queue<task_type>();
+        m_producer_queue.clear();
         m_producer_size = 0;
+        publish_producer_mask();
     }
 
     void clear_consumer()
     {
-        if constexpr (PriorityEnabled)
-            m_consumer_queue = std::priority_queue<task_type>();
-        else
-            m_consumer_queue = std::queue<task_type>();
+        m_consumer_queue.clear();
         m_consumer_size = 0;
     }
 
@@ -613,13 +2108,22 @@ private:
     mutable std::mutex m_put_mutex;
     mutable std::mutex m_get_mutex;
     std::condition_variable m_put_cv;
-    std::condition_variable m_get_cv;
     
     queue_type m_producer_queue;
     queue_type m_consumer_queue;
     
     size_t m_producer_size = 0;
     size_t m_consumer_size = 0;
+
+    // 两端队列的总任务数（容量判断用），容量上限与阻塞中的生产者数
+    std::atomic<size_t> m_size{0};
+    std::atomic<size_t> m_high_water{0};
+    std::atomic<size_t> m_capacity{0};
+    std::atomic<size_t> m_blocked_producers{0};
+
+    std::atomic<unsigned> m_producer_mask{0};
+
+    std::conditional_t<MetricsEnabled, std::atomic<std::uint64_t>, std::monostate> m_swaps{};
 };
 
 // ============================================================================
@@ -633,6 +2137,11 @@ public:
     static constexpr bool priority_enabled = has_flag(Flags, tp_flag::priority);
     static constexpr bool pause_enabled = has_flag(Flags, tp_flag::pause);
     static constexpr bool deadlock_check_enabled = has_flag(Flags, tp_flag::deadlock_check);
+    static constexpr bool work_stealing_enabled = has_flag(Flags, tp_flag::work_stealing);
+    static constexpr bool metrics_enabled = has_flag(Flags, tp_flag::metrics);
+
+    /// work_stealing 模式下可同时存在的工作线程数上限
+    static constexpr std::size_t max_ws_workers = 256;
 
     // ========================================================================
     // 构造与析构
@@ -643,13 +2152,25 @@ public:
     explicit ThreadPool(std::size_t num_threads)
         : ThreadPool(num_threads, [](std::size_t) {}) {}
 
-    template <typename F>
-    explicit ThreadPool(F &&init)
-        : ThreadPool(0, std::forward<F>(init)) {}
+    template <typename F, typename = std::enable_if_t<!std::is_integral_v<std::decay_t<F>>>>
+    explicit ThreadPool(F &&init)
+        : ThreadPool(0, std::forward<F>(init)) {}
+
+    template <typename F>
+    ThreadPool(std::size_t num_threads, F &&init)
+    {
+        create_threads(num_threads, std::forward<F>(init));
+    }
+
+    ThreadPool(std::size_t num_threads, thread_options options)
+        : ThreadPool(num_threads, std::move(options), [](std::size_t) {}) {}
 
+    // 工作线程启动时先应用放置参数，再执行 init
     template <typename F>
-    ThreadPool(std::size_t num_threads, F &&init)
+    ThreadPool(std::size_t num_threads, thread_options options, F &&init)
     {
+        m_cpu_plan = placement::plan(options);
+        m_thread_options = std::move(options);
         create_threads(num_threads, std::forward<F>(init));
     }
 
@@ -657,6 +2178,22 @@ public:
     {
         wait();
         stop_threads();
+
+        // stop() 后全局队列可能残留任务，在其他成员仍有效时销毁（析构可能恢复协程并回访本池）
+        m_task_queue.clear();
+
+        if constexpr (work_stealing_enabled)
+        {
+            // stop() 后可能残留未执行的本地任务
+            for (std::size_t i = 0; i < max_ws_workers; ++i)
+            {
+                std::unique_ptr<ws_deque_t> &dq = m_ws_deques[i];
+                if (!dq)
+                    continue;
+                while (auto item = dq->pop())
+                    ws_node_cache::release(*item);
+            }
+        }
     }
 
     ThreadPool(const ThreadPool &) = delete;
@@ -668,11 +2205,19 @@ public:
     // 任务提交 - detach (不等待结果)
     // ========================================================================
 
+    // 全局队列已满且被拒绝时抛出 queue_full
     template <typename F>
     void detach(F &&task, priority_t priority = 0)
     {
-        check_deadlock("detach");
-        enqueue_task(std::forward<F>(task), priority);
+        if (enqueue_task(std::forward<F>(task), priority) == admission::rejected)
+            throw queue_full();
+    }
+
+    // 与 detach 相同，但被拒绝时返回 false（线程池已停止时同样返回 false）
+    template <typename F>
+    [[nodiscard]] bool try_detach(F &&task, priority_t priority = 0)
+    {
+        return enqueue_task(std::forward<F>(task), priority) == admission::accepted;
     }
 
     template <typename T1, typename T2, typename F>
@@ -680,9 +2225,9 @@ public:
                        std::size_t num_blocks = 0, priority_t priority = 0)
     {
         using T = std::common_type_t<T1, T2>;
-        enqueue_blocks<T>(static_cast<T>(first), static_cast<T>(last),
-                          std::forward<F>(block), num_blocks, priority,
-                          std::false_type{});
+        enqueue_blocks<T, void>(static_cast<T>(first), static_cast<T>(last),
+                                std::forward<F>(block), num_blocks, priority,
+                                std::false_type{});
     }
 
     template <typename T1, typename T2, typename F>
@@ -702,19 +2247,29 @@ public:
     void detach_sequence(T1 first, T2 last, F &&seq, priority_t priority = 0)
     {
         using T = std::common_type_t<T1, T2>;
+        if (static_cast<T>(last) <= static_cast<T>(first))
+            return;
+        task_batch_t batch;
+        batch.reserve(static_cast<std::size_t>(static_cast<T>(last) - static_cast<T>(first)));
         for (T i = static_cast<T>(first); i < static_cast<T>(last); ++i)
         {
-            detach([seq, i]() { seq(i); }, priority);
+            batch.emplace_back([seq, i]() { seq(i); }, priority);
         }
+        if (enqueue_batch(std::move(batch)) > 0)
+            throw queue_full();
     }
 
     template <typename Iterator>
     void detach_bulk(Iterator first, Iterator last, priority_t priority = 0)
     {
+        task_batch_t batch;
+        batch.reserve(static_cast<std::size_t>(std::distance(first, last)));
         for (auto it = first; it != last; ++it)
         {
-            detach(*it, priority);
+            batch.emplace_back(move_only_function<void()>(*it), priority);
         }
+        if (enqueue_batch(std::move(batch)) > 0)
+            throw queue_full();
     }
 
     // ========================================================================
@@ -728,23 +2283,24 @@ public:
         using R = std::invoke_result_t<std::decay_t<F>>;
         task_with_future<R> twf(std::forward<F>(task));
         std::future<R> future = std::move(twf.future);
-        enqueue_task(std::move(twf.task), priority);
+        if (enqueue_task(std::move(twf.task), priority) == admission::rejected)
+            throw queue_full();
         return future;
     }
 
     template <typename T1, typename T2, typename F, typename R = std::invoke_result_t<F, T1, T2>>
-    [[nodiscard]] multi_future<R> submit_blocks(T1 first, T2 last, F &&block,
+    [[nodiscard]] task_group<R> submit_blocks(T1 first, T2 last, F &&block,
                                                 std::size_t num_blocks = 0,
                                                 priority_t priority = 0)
     {
         using T = std::common_type_t<T1, T2>;
-        return enqueue_blocks<T>(static_cast<T>(first), static_cast<T>(last),
-                                 std::forward<F>(block), num_blocks, priority,
-                                 std::true_type{});
+        return enqueue_blocks<T, R>(static_cast<T>(first), static_cast<T>(last),
+                                    std::forward<F>(block), num_blocks, priority,
+                                    std::true_type{});
     }
 
     template <typename T1, typename T2, typename F>
-    [[nodiscard]] multi_future<void> submit_loop(T1 first, T2 last, F &&loop,
+    [[nodiscard]] task_group<void> submit_loop(T1 first, T2 last, F &&loop,
                                                  std::size_t num_blocks = 0,
                                                  priority_t priority = 0)
     {
@@ -761,30 +2317,78 @@ public:
     [[nodiscard]] multi_future<R> submit_sequence(T1 first, T2 last, F &&seq,
                                                   priority_t priority = 0)
     {
+        check_deadlock("submit");
         using T = std::common_type_t<T1, T2>;
         std::vector<std::future<R>> futures;
-        futures.reserve(static_cast<std::size_t>(last - first));
+        if (static_cast<T>(last) <= static_cast<T>(first))
+            return multi_future<R>(std::move(futures));
+        std::size_t count = static_cast<std::size_t>(static_cast<T>(last) - static_cast<T>(first));
+        futures.reserve(count);
+        task_batch_t batch;
+        batch.reserve(count);
         for (T i = static_cast<T>(first); i < static_cast<T>(last); ++i)
         {
-            futures.push_back(submit([seq, i]() { return seq(i); }, priority));
+            task_with_future<R> twf([seq, i]() { return seq(i); });
+            futures.push_back(std::move(twf.future));
+            batch.emplace_back(std::move(twf.task), priority);
         }
+        if (enqueue_batch(std::move(batch)) > 0)
+            throw queue_full();
         return multi_future<R>(std::move(futures));
     }
 
     template <typename Iterator>
     [[nodiscard]] auto submit_bulk(Iterator first, Iterator last, priority_t priority = 0)
     {
+        check_deadlock("submit");
         using F = decltype(*first);
         using R = std::invoke_result_t<std::decay_t<F>>;
+        std::size_t count = static_cast<std::size_t>(std::distance(first, last));
         std::vector<std::future<R>> futures;
-        futures.reserve(static_cast<std::size_t>(std::distance(first, last)));
+        futures.reserve(count);
+        task_batch_t batch;
+        batch.reserve(count);
         for (auto it = first; it != last; ++it)
         {
-            futures.push_back(submit(*it, priority));
+            task_with_future<R> twf(*it);
+            futures.push_back(std::move(twf.future));
+            batch.emplace_back(std::move(twf.task), priority);
         }
+        if (enqueue_batch(std::move(batch)) > 0)
+            throw queue_full();
         return multi_future<R>(std::move(futures));
     }
 
+#ifdef THREADPOOL_HAS_COROUTINE
+    // ========================================================================
+    // 协程支持：co_await pool.schedule() 将当前协程切换到工作线程继续执行
+    // ========================================================================
+
+    [[nodiscard]] auto schedule(priority_t priority = 0) noexcept
+    {
+        struct awaiter
+        {
+            ThreadPool *pool;
+            priority_t priority;
+
+            bool await_ready() const noexcept { return false; }
+
+            // 线程池已停止或队列已满时不挂起，在当前线程继续执行；
+            // 提交期间被拒绝而析构的作业不恢复协程，由返回 false 恢复
+            bool await_suspend(std::coroutine_handle<> handle)
+            {
+                void *prev = std::exchange(resume_job::s_submitting, handle.address());
+                admission result = pool->enqueue_task(resume_job(handle), priority, false);
+                resume_job::s_submitting = prev;
+                return result == admission::accepted;
+            }
+
+            void await_resume() const noexcept {}
+        };
+        return awaiter{this, priority};
+    }
+
+#endif
     // ========================================================================
     // 线程管理
     // ========================================================================
@@ -800,39 +2404,44 @@ public:
         return m_active_threads.load(std::memory_order_acquire);
     }
 
+    // 全局队列与各线程本地队列中尚未开始执行的任务数（原子计数，不加锁）
     [[nodiscard]] std::size_t queued_tasks() const
     {
-        return m_task_queue.approximate_size();
+        return m_pending.load(std::memory_order_acquire);
     }
 
     void purge()
     {
-        m_task_queue.clear();
+        // 先扣除计数再析构任务：析构中恢复的协程可能调用 wait
+        m_task_queue.clear([this](std::size_t count) {
+            if (count > 0)
+                unaccount(count);
+        });
     }
 
     void wait()
     {
         check_deadlock("wait");
-        std::unique_lock<std::mutex> lock(m_mutex);
-        m_done_cv.wait(lock, [this] {
-            if constexpr (pause_enabled)
-                return m_active_threads == 0 && (m_paused || m_task_queue.approximate_size() == 0);
-            else
-                return m_active_threads == 0 && m_task_queue.approximate_size() == 0;
-        });
+        m_done_waiters.fetch_add(1, std::memory_order_seq_cst);
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_done_cv.wait(lock, [this] { return all_done(); });
+        }
+        m_done_waiters.fetch_sub(1, std::memory_order_release);
     }
 
     template <typename Rep, typename Period>
     bool wait_for(const std::chrono::duration<Rep, Period> &duration)
     {
         check_deadlock("wait_for");
-        std::unique_lock<std::mutex> lock(m_mutex);
-        return m_done_cv.wait_for(lock, duration, [this] {
-            if constexpr (pause_enabled)
-                return m_active_threads == 0 && (m_paused || m_task_queue.approximate_size() == 0);
-            else
-                return m_active_threads == 0 && m_task_queue.approximate_size() == 0;
-        });
+        m_done_waiters.fetch_add(1, std::memory_order_seq_cst);
+        bool done;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            done = m_done_cv.wait_for(lock, duration, [this] { return all_done(); });
+        }
+        m_done_waiters.fetch_sub(1, std::memory_order_release);
+        return done;
     }
 
     // ========================================================================
@@ -864,29 +2473,17 @@ public:
         if (count >= current)
             return false;
             
-        // 借鉴 C 版本：向队列头部插入特殊退出任务
+        // 登记退出请求并唤醒空闲线程，由先看到请求的线程认领退出
         m_pending_exits += count;
-        
-        for (std::size_t i = 0; i < count; ++i)
-        {
-            // 创建特殊退出任务
-            task_wrapper<priority_enabled> exit_task;
-            exit_task.task = [this]() {
-                // 退出任务：线程将检测到并退出
-            };
-            // 标记为特殊任务
-            m_task_queue.put_front(std::move(exit_task));
-        }
-        
-        m_task_queue.notify_all_consumers();
+        m_idle_event.notify_all();
         
         // 等待线程退出
         m_exit_cv.wait(lock, [this, count] {
             return m_exited_count >= count;
         });
         
+        // m_pending_exits 已由退出的线程逐个扣减
         m_exited_count -= count;
-        m_pending_exits -= count;
         
         // 清理已退出的线程对象
         cleanup_exited_threads();
@@ -894,10 +2491,148 @@ public:
         return true;
     }
 
+    // 空闲线程休眠前自旋等待的上限，0 表示不自旋直接休眠
+    void set_idle_spin(std::chrono::nanoseconds limit) noexcept
+    {
+        m_idle_spin_ns.store(limit.count(), std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] std::chrono::nanoseconds idle_spin() const noexcept
+    {
+        return std::chrono::nanoseconds(m_idle_spin_ns.load(std::memory_order_relaxed));
+    }
+
+    // 修改放置参数：立即应用到现有工作线程（按当前顺序编号），之后新增的线程启动时应用
+    void set_thread_options(thread_options options)
+    {
+        std::vector<std::vector<int>> cpu_plan = placement::plan(options);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::lock_guard<std::mutex> options_lock(m_options_mutex);
+        m_thread_options = std::move(options);
+        m_cpu_plan = std::move(cpu_plan);
+        for (std::size_t i = 0; i < m_threads.size(); ++i)
+            placement::apply(m_threads[i].native_handle(), i, m_thread_options, m_cpu_plan);
+    }
+
+    [[nodiscard]] thread_options get_thread_options() const
+    {
+        std::lock_guard<std::mutex> lock(m_options_mutex);
+        return m_thread_options;
+    }
+
+    // 全局队列容量上限（0 表示不限）与队列满时的策略；block 策略等待超过 block_timeout 视为拒绝。
+    // 批量提交逐个按策略入队，出现拒绝时已入队的任务照常执行，接口抛出 queue_full
+    void set_queue_limit(std::size_t capacity, overflow_policy policy = overflow_policy::block,
+                         std::chrono::nanoseconds block_timeout = std::chrono::nanoseconds::max())
+    {
+        m_overflow_policy.store(policy, std::memory_order_relaxed);
+        m_block_timeout_ns.store(block_timeout.count(), std::memory_order_relaxed);
+        m_task_queue.set_capacity(capacity);
+    }
+
+    // 运行指标快照，需要 tp_flag::metrics；已退出线程的累计值仍计入
+    [[nodiscard]] metrics_snapshot metrics() const
+    {
+        static_assert(metrics_enabled, "metrics() requires tp_flag::metrics");
+        metrics_snapshot snap;
+        std::int64_t now = steady_now_ns();
+        std::uint64_t busy_total = 0;
+        std::uint64_t life_total = 0;
+
+        auto &registry = m_metrics;
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        for (const auto &w : registry.workers)
+        {
+            worker_metrics_snapshot ws;
+            ws.index = w->index;
+            std::int64_t end = w->end_ns.load(std::memory_order_relaxed);
+            ws.running = end == 0;
+            std::uint64_t lifetime = static_cast<std::uint64_t>(std::max<std::int64_t>(0, (ws.running ? now : end) - w->start_ns));
+            ws.busy_ns = std::min(w->busy_ns.load(std::memory_order_relaxed), lifetime);
+            ws.idle_ns = lifetime - ws.busy_ns;
+            ws.tasks = w->tasks.load(std::memory_order_relaxed);
+            ws.steals = w->steals.load(std::memory_order_relaxed);
+            ws.busy_ratio = lifetime ? static_cast<double>(ws.busy_ns) / static_cast<double>(lifetime) : 0.0;
+
+            w->queue_wait.snapshot_into(snap.queue_wait);
+            w->run_time.snapshot_into(snap.run_time);
+            snap.tasks += ws.tasks;
+            snap.steals += ws.steals;
+            busy_total += ws.busy_ns;
+            life_total += lifetime;
+            snap.workers.push_back(ws);
+        }
+        registry.external.queue_wait.snapshot_into(snap.queue_wait);
+        registry.external.run_time.snapshot_into(snap.run_time);
+        snap.caller_ran = registry.external.tasks.load(std::memory_order_relaxed);
+        snap.tasks += snap.caller_ran;
+        snap.swaps = m_task_queue.swap_count();
+        snap.busy_ratio = life_total ? static_cast<double>(busy_total) / static_cast<double>(life_total) : 0.0;
+        return snap;
+    }
+
+    // ========================================================================
+    // 定时任务：到期后作为普通任务投递（届时才计入 wait()），由工作线程在任务间隙
+    // 与空闲休眠的超时中检查，不额外创建线程。因此所有工作线程都在执行长任务时，
+    // 到期的定时任务要等到某个线程完成当前任务后才投递；对时效敏感的定时任务
+    // 不宜与长任务共用线程池。
+    // 有界队列拒绝或 drop_oldest 丢弃、purge 清除某次投递时，周期任务跳过这一次，
+    // 按原相位继续执行，一次性任务则被丢弃（计入 rejected/dropped）
+    // ========================================================================
+
+    template <typename Rep, typename Period, typename F>
+    timer_handle schedule_after(const std::chrono::duration<Rep, Period> &delay, F &&task,
+                                priority_t priority = 0)
+    {
+        return add_timer(steady_now_ns() + to_ns(delay), 0, std::forward<F>(task), priority);
+    }
+
+    template <typename Clock, typename Duration, typename F>
+    timer_handle schedule_at(const std::chrono::time_point<Clock, Duration> &time, F &&task,
+                             priority_t priority = 0)
+    {
+        // 其他时钟的时间点按当前偏差换算到 steady_clock
+        return add_timer(steady_now_ns() + to_ns(time - Clock::now()), 0, std::forward<F>(task), priority);
+    }
+
+    // 首次在一个周期后执行，之后按固定频率执行；同一定时任务不会并发执行，
+    // 执行耗时超过周期时跳过错过的时刻，保持原有相位
+    template <typename Rep, typename Period, typename F>
+    timer_handle schedule_every(const std::chrono::duration<Rep, Period> &period, F &&task,
+                                priority_t priority = 0)
+    {
+        std::int64_t period_ns = to_ns(period);
+        if (period_ns <= 0)
+            throw threadpool_error("schedule_every: period must be positive");
+        return add_timer(steady_now_ns() + period_ns, period_ns, std::forward<F>(task), priority);
+    }
+
+    // 尚未到期的定时任务数（含已取消但尚未到期的）
+    [[nodiscard]] std::size_t pending_timers() const
+    {
+        std::lock_guard<std::mutex> lock(m_timer_mutex);
+        return m_timers.size();
+    }
+
+    [[nodiscard]] queue_stats get_queue_stats() const noexcept
+    {
+        queue_stats stats;
+        stats.depth = m_task_queue.size();
+        stats.capacity = m_task_queue.capacity();
+        stats.high_water = m_task_queue.high_water();
+        stats.blocked = m_blocked_count.load(std::memory_order_relaxed);
+        stats.rejected = m_rejected_count.load(std::memory_order_relaxed);
+        stats.dropped = m_dropped_count.load(std::memory_order_relaxed);
+        stats.caller_ran = m_caller_ran_count.load(std::memory_order_relaxed);
+        return stats;
+    }
+
     void stop()
     {
         m_stop.store(true, std::memory_order_release);
-        m_task_queue.notify_all_consumers();
+        m_idle_event.notify_all();
+        m_task_queue.notify_all_producers();
+        notify_done();
     }
 
     // ========================================================================
@@ -907,8 +2642,11 @@ public:
     template <bool P = pause_enabled, typename = std::enable_if_t<P>>
     void pause()
     {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        m_paused = true;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_paused = true;
+        }
+        notify_done();
     }
 
     template <bool P = pause_enabled, typename = std::enable_if_t<P>>
@@ -918,7 +2656,7 @@ public:
             std::lock_guard<std::mutex> lock(m_mutex);
             m_paused = false;
         }
-        m_task_queue.notify_all_consumers();
+        m_idle_event.notify_all();
     }
 
     template <bool P = pause_enabled, typename = std::enable_if_t<P>>
@@ -928,80 +2666,474 @@ public:
         return m_paused;
     }
 
-    // ========================================================================
-    // 重置
-    // ========================================================================
+    // ========================================================================
+    // 重置
+    // ========================================================================
+
+    void reset()
+    {
+        reset(0, [](std::size_t) {});
+    }
+
+    void reset(std::size_t num_threads)
+    {
+        reset(num_threads, [](std::size_t) {});
+    }
+
+    template <typename F>
+    void reset(F &&init)
+    {
+        reset(0, std::forward<F>(init));
+    }
+
+    template <typename F>
+    void reset(std::size_t num_threads, F &&init)
+    {
+        wait();
+        stop_threads();
+        
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_threads.clear();
+            m_stop.store(false, std::memory_order_release);
+            m_pending_exits = 0;
+            m_exited_count = 0;
+            if constexpr (pause_enabled)
+                m_paused = false;
+        }
+        
+        create_threads(num_threads, std::forward<F>(init));
+    }
+
+private:
+    // ========================================================================
+    // 内部实现
+    // ========================================================================
+
+    using task_item_t = task_wrapper<priority_enabled, metrics_enabled>;
+    using task_queue_t = dual_task_queue<priority_enabled, metrics_enabled>;
+    using task_batch_t = std::vector<task_item_t>;
+    using ws_task_t = task_wrapper<false, metrics_enabled>;
+    using ws_node_cache = task_node_cache<ws_task_t>;
+    using ws_deque_t = ws_deque<ws_task_t *>;
+    using metrics_slot_t = std::conditional_t<metrics_enabled, worker_metrics, std::monostate>;
+
+    // metrics 模式：已注册的工作线程计数与提交线程（caller_runs）共享的计数
+    struct metrics_registry
+    {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<worker_metrics>> workers;
+        worker_metrics external{static_cast<std::size_t>(-1), 0};
+    };
+
+    void check_deadlock(const char* operation) const
+    {
+        if constexpr (deadlock_check_enabled)
+        {
+            if (this_thread_info::get_pool() == static_cast<const void*>(this))
+            {
+                throw deadlock_detected();
+            }
+        }
+    }
+
+    enum class admission : uint8_t
+    {
+        accepted,   // 已入队、已在提交线程执行或为其丢弃了旧任务
+        rejected,
+        stopped
+    };
+
+    // may_run_inline 为 false 时 caller_runs 视为拒绝（协程 await_suspend 内不能恢复自身）
+    template <typename F>
+    admission enqueue_task(F &&task, priority_t priority, bool may_run_inline = true)
+    {
+        if (m_stop.load(std::memory_order_acquire))
+            return admission::stopped;
+
+        // 先计数再入队：工作线程看到计数时任务可能尚未可见，只会短暂重试，不会漏掉任务
+        m_unfinished.fetch_add(1, std::memory_order_relaxed);
+        m_pending.fetch_add(1, std::memory_order_release);
+
+        if constexpr (work_stealing_enabled)
+        {
+            // 本池工作线程内提交：进入本线程双端队列（忽略优先级），全局队列只接收外部提交
+            if (this_thread_info::s_pool == static_cast<void *>(this) &&
+                this_thread_info::s_local_queue != nullptr)
+            {
+                auto *dq = static_cast<ws_deque_t *>(this_thread_info::s_local_queue);
+                m_ws_pending.fetch_add(1, std::memory_order_release);
+                ws_task_t *node = ws_node_cache::acquire(std::forward<F>(task));
+                stamp(*node);
+                dq->push(node);
+                wake_one();
+                return admission::accepted;
+            }
+        }
+
+        task_item_t item(move_only_function<void()>(std::forward<F>(task)), priority);
+        stamp(item);
+        if (m_task_queue.capacity() != 0)
+            return admit(item, may_run_inline);
+
+        m_task_queue.put(std::move(item));
+        wake_one();
+        return admission::accepted;
+    }
+
+    // 批量入队：计数一次、加锁一次，唤醒 min(批量, 空闲线程) 个线程；
+    // 队列有容量上限时逐个按溢出策略入队，返回被拒绝的任务数
+    std::size_t enqueue_batch(task_batch_t &&batch)
+    {
+        std::size_t count = batch.size();
+        if (count == 0 || m_stop.load(std::memory_order_acquire))
+            return 0;
+
+        m_unfinished.fetch_add(count, std::memory_order_relaxed);
+        m_pending.fetch_add(count, std::memory_order_release);
+
+        if constexpr (metrics_enabled)
+        {
+            std::int64_t now = steady_now_ns();
+            for (auto &item : batch)
+                item.enqueue_ns = now;
+        }
+
+        if constexpr (work_stealing_enabled)
+        {
+            if (this_thread_info::s_pool == static_cast<void *>(this) &&
+                this_thread_info::s_local_queue != nullptr)
+            {
+                auto *dq = static_cast<ws_deque_t *>(this_thread_info::s_local_queue);
+                m_ws_pending.fetch_add(count, std::memory_order_release);
+                for (auto &item : batch)
+                {
+                    ws_task_t *node = ws_node_cache::acquire(std::move(item.task));
+                    copy_stamp(*node, item);
+                    dq->push(node);
+                }
+                wake_n(count);
+                return 0;
+            }
+        }
+
+        if (m_task_queue.capacity() != 0)
+        {
+            std::size_t rejected = 0;
+            for (auto &item : batch)
+            {
+                if (admit(item, true) == admission::rejected)
+                    ++rejected;
+            }
+            return rejected;
+        }
+
+        m_task_queue.put_range(batch.begin(), batch.end());
+        wake_n(count);
+        return 0;
+    }
+
+    // 有容量上限时按溢出策略入队（任务已计入 m_pending / m_unfinished）
+    admission admit(task_item_t &item, bool may_run_inline)
+    {
+        overflow_policy policy = m_overflow_policy.load(std::memory_order_relaxed);
+
+        // 工作线程阻塞等待自己所在的池腾出空间可能死锁
+        if (policy == overflow_policy::block && this_thread_info::s_pool == static_cast<void *>(this))
+            policy = overflow_policy::caller_runs;
+
+        switch (policy)
+        {
+        case overflow_policy::block:
+        {
+            std::int64_t timeout = m_block_timeout_ns.load(std::memory_order_relaxed);
+            auto deadline = std::chrono::steady_clock::time_point::max();
+            if (timeout != std::chrono::nanoseconds::max().count())
+                deadline = std::chrono::steady_clock::now() + std::chrono::nanoseconds(timeout);
+            bool blocked = false;
+            bool accepted = m_task_queue.put_until(item, deadline, blocked, [this]()
+                                                   { return m_stop.load(std::memory_order_acquire); });
+            if (blocked)
+                m_blocked_count.fetch_add(1, std::memory_order_relaxed);
+            if (accepted)
+            {
+                wake_one();
+                return admission::accepted;
+            }
+            break;
+        }
+        case overflow_policy::reject:
+            if (m_task_queue.try_put(item))
+            {
+                wake_one();
+                return admission::accepted;
+            }
+            break;
+        case overflow_policy::caller_runs:
+            if (m_task_queue.try_put(item))
+            {
+                wake_one();
+                return admission::accepted;
+            }
+            if (!may_run_inline)
+                break;
+            m_caller_ran_count.fetch_add(1, std::memory_order_relaxed);
+            m_pending.fetch_sub(1, std::memory_order_release);
+            m_active_threads.fetch_add(1, std::memory_order_release);
+            if constexpr (metrics_enabled)
+                run_item(item, &m_metrics.external);
+            else
+                run_item(item, nullptr);
+            return admission::accepted;
+        case overflow_policy::drop_oldest:
+        {
+            std::optional<task_item_t> dropped;
+            bool accepted = m_task_queue.put_drop_oldest(item, dropped);
+            if (dropped)
+            {
+                m_dropped_count.fetch_add(1, std::memory_order_relaxed);
+                unaccount(1);
+            }
+            if (accepted)
+            {
+                wake_one();
+                return admission::accepted;
+            }
+            break;
+        }
+        }
+
+        m_rejected_count.fetch_add(1, std::memory_order_relaxed);
+        unaccount(1);
+        return admission::rejected;
+    }
+
+    // 撤销未执行任务的计数
+    void unaccount(std::size_t count)
+    {
+        m_pending.fetch_sub(count, std::memory_order_acq_rel);
+        if (m_unfinished.fetch_sub(count, std::memory_order_seq_cst) == count)
+            notify_done();
+    }
+
+    // ------------------------------------------------------------------------
+    // 定时任务实现：最小堆按 (到期时间, 序号) 排序，m_next_timer 缓存堆顶供无锁检查
+    // ------------------------------------------------------------------------
+
+    static constexpr std::int64_t no_timer = INT64_MAX;
+
+    struct timer_entry
+    {
+        std::int64_t due;
+        std::uint64_t seq;
+        std::shared_ptr<timer_state> state;
+    };
+
+    struct timer_later
+    {
+        bool operator()(const timer_entry &a, const timer_entry &b) const noexcept
+        {
+            return a.due != b.due ? a.due > b.due : a.seq > b.seq;
+        }
+    };
+
+    [[nodiscard]] static std::int64_t steady_now_ns() noexcept
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    template <typename Rep, typename Period>
+    [[nodiscard]] static std::int64_t to_ns(const std::chrono::duration<Rep, Period> &d) noexcept
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+    }
+
+    template <typename F>
+    timer_handle add_timer(std::int64_t due, std::int64_t period_ns, F &&task, priority_t priority)
+    {
+        auto state = std::make_shared<timer_state>();
+        state->task = move_only_function<void()>(std::forward<F>(task));
+        state->period_ns = period_ns;
+        state->priority = priority;
+        arm_timer(due, state);
+        return timer_handle(std::move(state));
+    }
+
+    // 新定时任务早于当前堆顶时唤醒一个休眠线程，使其按新的到期时间重新休眠
+    void arm_timer(std::int64_t due, std::shared_ptr<timer_state> state)
+    {
+        bool earliest = false;
+        {
+            std::lock_guard<std::mutex> lock(m_timer_mutex);
+            m_timers.push_back(timer_entry{due, m_timer_seq++, std::move(state)});
+            std::push_heap(m_timers.begin(), m_timers.end(), timer_later{});
+            if (due < m_next_timer.load(std::memory_order_relaxed))
+            {
+                m_next_timer.store(due, std::memory_order_seq_cst);
+                earliest = true;
+            }
+        }
+        if (earliest)
+            m_idle_event.notify_one();
+    }
+
+    [[nodiscard]] bool timers_due() const noexcept
+    {
+        std::int64_t next = m_next_timer.load(std::memory_order_seq_cst);
+        return next != no_timer && steady_now_ns() >= next;
+    }
+
+    // 取出所有到期的定时任务并整批投递
+    void fire_due_timers()
+    {
+        task_batch_t batch;
+        {
+            std::lock_guard<std::mutex> lock(m_timer_mutex);
+            std::int64_t now = steady_now_ns();
+            while (!m_timers.empty() && m_timers.front().due <= now)
+            {
+                std::pop_heap(m_timers.begin(), m_timers.end(), timer_later{});
+                timer_entry entry = std::move(m_timers.back());
+                m_timers.pop_back();
+                if (entry.state->cancelled.load(std::memory_order_acquire))
+                    continue;
+                priority_t priority = entry.state->priority;
+                batch.emplace_back(timer_job(this, entry.due, std::move(entry.state)), priority);
+            }
+            m_next_timer.store(m_timers.empty() ? no_timer : m_timers.front().due,
+                               std::memory_order_seq_cst);
+        }
+        // 被拒绝的作业随 batch 在锁外析构，由 timer_job 重新挂入下一周期
+        enqueue_batch(std::move(batch));
+    }
+
+    // 定时任务作业：执行完毕后挂入下一周期，保证同一定时任务不并发执行；
+    // 未执行即被销毁（拒绝、丢弃、清除）时同样挂入下一周期，周期任务不会因此失效
+    class timer_job
+    {
+    public:
+        timer_job(ThreadPool *pool, std::int64_t due, std::shared_ptr<timer_state> state) noexcept
+            : m_pool(pool), m_due(due), m_state(std::move(state)) {}
+        timer_job(timer_job &&) noexcept = default;
+        timer_job(const timer_job &) = delete;
+        timer_job &operator=(const timer_job &) = delete;
+        timer_job &operator=(timer_job &&) = delete;
 
-    void reset()
+        ~timer_job()
+        {
+            if (m_state)
+                m_pool->rearm_timer(m_due, std::move(m_state));
+        }
+
+        void operator()()
+        {
+            std::shared_ptr<timer_state> state = std::move(m_state);
+            if (state->cancelled.load(std::memory_order_acquire))
+                return;
+#ifdef __cpp_exceptions
+            try
+            {
+#endif
+                state->task();
+#ifdef __cpp_exceptions
+            }
+            catch (...)
+            {
+                // 周期任务的单次异常不影响后续执行
+            }
+#endif
+            m_pool->rearm_timer(m_due, std::move(state));
+        }
+
+    private:
+        ThreadPool *m_pool;
+        std::int64_t m_due;
+        std::shared_ptr<timer_state> m_state;
+    };
+
+    // 周期任务按原相位挂入 due 之后的下一个未错过的时刻
+    void rearm_timer(std::int64_t due, std::shared_ptr<timer_state> state)
     {
-        reset(0, [](std::size_t) {});
+        if (state->period_ns == 0 || state->cancelled.load(std::memory_order_acquire) ||
+            m_stop.load(std::memory_order_acquire))
+            return;
+
+        std::int64_t next = due + state->period_ns;
+        std::int64_t now = steady_now_ns();
+        if (next <= now)
+            next += ((now - next) / state->period_ns + 1) * state->period_ns;
+        arm_timer(next, std::move(state));
     }
 
-    void reset(std::size_t num_threads)
+    // 有线程在自旋时由其取走任务，不进入内核；
+    // 自旋线程拿到任务后若仍有积压会继续唤醒下一个（见 worker）
+    void wake_one()
     {
-        reset(num_threads, [](std::size_t) {});
+        wake_n(1);
     }
 
-    template <typename F>
-    void reset(F &&init)
+    void wake_n(std::size_t count)
     {
-        reset(0, std::forward<F>(init));
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::size_t spinning = m_spinning.load(std::memory_order_relaxed);
+        if (spinning >= count)
+            return;
+        m_idle_event.notify_n(count - spinning);
     }
 
-    template <typename F>
-    void reset(std::size_t num_threads, F &&init)
+    // 休眠前自旋：_mm_pause 指数退避，后半程改为 yield；返回期间是否出现可处理的工作
+    bool spin_for_work(std::chrono::nanoseconds budget)
     {
-        wait();
-        stop_threads();
-        
+        if (budget.count() <= 0)
+            return false;
+        if (m_spinning.fetch_add(1, std::memory_order_seq_cst) >= m_max_spinners)
         {
-            std::lock_guard<std::mutex> lock(m_mutex);
-            m_threads.clear();
-            m_stop.store(false, std::memory_order_release);
-            m_pending_exits = 0;
-            m_exited_count = 0;
-            if constexpr (pause_enabled)
-                m_paused = false;
+            m_spinning.fetch_sub(1, std::memory_order_seq_cst);
+            return false;
         }
-        
-        create_threads(num_threads, std::forward<F>(init));
-    }
-
-private:
-    // ========================================================================
-    // 内部实现
-    // ========================================================================
 
-    using task_queue_t = dual_task_queue<priority_enabled>;
+        constexpr unsigned max_backoff = 64;
+        auto start = idle_spin_state::clock::now();
+        auto yield_after = start + budget / 2;
+        auto deadline = start + budget;
+        unsigned backoff = 1;
+        bool found = false;
 
-    void check_deadlock(const char* operation) const
-    {
-        if constexpr (deadlock_check_enabled)
+        while (true)
         {
-            if (this_thread_info::get_pool() == static_cast<const void*>(this))
+            if (has_work())
             {
-                throw deadlock_detected();
+                found = true;
+                break;
+            }
+            auto now = idle_spin_state::clock::now();
+            if (now >= deadline)
+                break;
+            if (now < yield_after)
+            {
+                for (unsigned i = 0; i < backoff; ++i)
+                    cpu_relax();
+                if (backoff < max_backoff)
+                    backoff <<= 1;
+            }
+            else
+            {
+                std::this_thread::yield();
             }
         }
+        // 退出自旋后仍需经过 prepare_wait 复查，生产者跳过的唤醒不会丢失
+        m_spinning.fetch_sub(1, std::memory_order_seq_cst);
+        return found;
     }
 
-    template <typename F>
-    void enqueue_task(F &&task, priority_t priority)
-    {
-        if (m_stop.load(std::memory_order_acquire))
-            return;
-            
-        m_task_queue.put(task_wrapper<priority_enabled>(
-            move_only_function<void()>(std::forward<F>(task)), priority));
-        m_task_queue.notify_consumer();
-    }
-
-    template <typename T, typename F, typename R, bool Submit>
+    template <typename T, typename R, typename F, bool Submit>
     auto enqueue_blocks(T first, T last, F &&block,
                         std::size_t num_blocks, priority_t priority,
                         std::integral_constant<bool, Submit>)
     {
-        using result_t = std::conditional_t<Submit, multi_future<R>, void>;
+        using result_t = std::conditional_t<Submit, task_group<R>, void>;
         
         if (last <= first)
             return result_t();
@@ -1013,33 +3145,54 @@ private:
         if (nblocks == 0)
             return result_t();
 
-        std::vector<std::conditional_t<Submit, std::future<R>, move_only_function<void()>>> items;
-        items.reserve(nblocks);
+        task_batch_t batch;
+        batch.reserve(nblocks);
 
-        auto block_ptr = std::make_shared<std::decay_t<F>>(std::forward<F>(block));
-
-        for (std::size_t i = 0; i < nblocks; ++i)
+        if constexpr (Submit)
         {
-            auto start = range.start(i);
-            auto end = range.end(i);
-            if constexpr (Submit)
+            // 所有块共享一个 task_group 状态，队列中的任务只负责领取块
+            using state_t = task_group_state<R>;
+            auto state = std::make_shared<state_t>(
+                nblocks,
+                [block = std::forward<F>(block), range](state_t &st, std::size_t i) mutable
+                {
+                    if constexpr (std::is_void_v<R>)
+                        block(range.start(i), range.end(i));
+                    else
+                        st.results[i].emplace(block(range.start(i), range.end(i)));
+                });
+
+            // 每个线程最多需要一个领取任务，领取任务循环执行直到块被领完
+            std::size_t workers = std::min(nblocks, std::max<std::size_t>(1, thread_count()));
+            for (std::size_t i = 0; i < workers; ++i)
             {
-                items.push_back(submit([block_ptr, start, end]() -> R
-                                       { return (*block_ptr)(start, end); }, priority));
+                batch.emplace_back([state]()
+                                   {
+                                       while (state->run_one())
+                                       {
+                                       }
+                                   }, priority);
             }
-            else
+            // 领取任务被队列拒绝时无需处理：等待方在 wait() 中协助执行剩余的块
+            enqueue_batch(std::move(batch));
+            return task_group<R>(std::move(state));
+        }
+        else
+        {
+            auto block_ptr = std::make_shared<std::decay_t<F>>(std::forward<F>(block));
+
+            for (std::size_t i = 0; i < nblocks; ++i)
             {
-                items.emplace_back([block_ptr, start, end]()
-                                   { (*block_ptr)(start, end); });
-                enqueue_task(std::move(items.back()), priority);
+                auto start = range.start(i);
+                auto end = range.end(i);
+                batch.emplace_back([block_ptr, start, end]()
+                                   { (*block_ptr)(start, end); }, priority);
             }
-        }
 
-        if constexpr (Submit)
-        {
-            return multi_future<R>(std::move(items));
+            if (enqueue_batch(std::move(batch)) > 0)
+                throw queue_full();
+            return result_t();
         }
-        return result_t();
     }
 
     template <typename F>
@@ -1094,26 +3247,283 @@ private:
 
     void cleanup_exited_threads()
     {
-        // 移除已 join 的线程
+        // join 并移除已响应退出请求的线程（调用方持有 m_mutex）
         m_threads.erase(
             std::remove_if(m_threads.begin(), m_threads.end(),
-                           [](auto& t) {
-#ifdef __cpp_lib_jthread
-                               return !t.joinable();
-#else
-                               if (t.joinable())
+                           [this](auto& t) {
+                               auto it = std::find(m_exited_ids.begin(), m_exited_ids.end(), t.get_id());
+                               if (it == m_exited_ids.end())
                                    return false;
+                               m_exited_ids.erase(it);
                                t.join();
                                return true;
-#endif
                            }),
             m_threads.end());
     }
 
+    // ------------------------------------------------------------------------
+    // work_stealing 支持
+    // ------------------------------------------------------------------------
+
+    // 为当前工作线程分配双端队列槽位，槽位在线程退出后复用
+    std::size_t ws_attach()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (std::size_t i = 0; i < max_ws_workers; ++i)
+        {
+            if (m_ws_slot_used[i])
+                continue;
+
+            m_ws_slot_used[i] = true;
+            if (!m_ws_deques[i])
+                m_ws_deques[i] = std::make_unique<ws_deque_t>();
+            if (i >= m_ws_slot_count.load(std::memory_order_relaxed))
+                m_ws_slot_count.store(i + 1, std::memory_order_release);
+            this_thread_info::s_local_queue = m_ws_deques[i].get();
+            return i;
+        }
+        throw threadpool_error("work_stealing: too many worker threads");
+    }
+
+    // 将本地剩余任务转入全局队列（不加锁）
+    void ws_drain(std::size_t slot)
+    {
+        ws_deque_t *dq = m_ws_deques[slot].get();
+        bool moved = false;
+        while (auto item = dq->pop())
+        {
+            task_item_t global(std::move((*item)->task));
+            copy_stamp(global, **item);
+            m_task_queue.put(std::move(global));
+            ws_node_cache::release(*item);
+            m_ws_pending.fetch_sub(1, std::memory_order_release);
+            moved = true;
+        }
+        if (moved)
+            m_idle_event.notify_all();
+    }
+
+    // 释放槽位，调用方持有 m_mutex
+    void ws_release_slot_locked(std::size_t slot)
+    {
+        this_thread_info::s_local_queue = nullptr;
+        m_ws_slot_used[slot] = false;
+    }
+
+    // 线程退出前将本地剩余任务转入全局队列并归还槽位
+    void ws_detach(std::size_t slot)
+    {
+        ws_drain(slot);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ws_release_slot_locked(slot);
+    }
+
+    // 先取本线程队列，再随机选择起点轮询窃取其他线程
+    ws_task_t *ws_find_task(std::size_t slot, metrics_slot_t *stats)
+    {
+        if (auto item = m_ws_deques[slot]->pop())
+            return *item;
+
+        std::size_t n = m_ws_slot_count.load(std::memory_order_acquire);
+        if (n <= 1 || m_ws_pending.load(std::memory_order_acquire) == 0)
+            return nullptr;
+
+        thread_local std::uint64_t seed = 0x9E3779B97F4A7C15ULL ^ (slot + 1);
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+
+        std::size_t start = static_cast<std::size_t>(seed % n);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            std::size_t victim = (start + i) % n;
+            if (victim == slot)
+                continue;
+            ws_deque_t *dq = ws_deque_at(victim);
+            if (!dq)
+                continue;
+            if (auto item = dq->steal())
+            {
+                if constexpr (metrics_enabled)
+                    stats->steals.fetch_add(1, std::memory_order_relaxed);
+                else
+                    (void)stats;
+                return *item;
+            }
+        }
+        return nullptr;
+    }
+
+    ws_deque_t *ws_deque_at(std::size_t i)
+    {
+        // 槽位队列只创建不销毁，m_ws_slot_count 的 release 保证可见
+        return m_ws_deques[i].get();
+    }
+
+    void run_task(move_only_function<void()> &task)
+    {
+        invoke_task(task);
+        finish_task();
+    }
+
+    // metrics 模式下记录排队与执行耗时；在完成计数之前记录，wait() 返回后快照即包含本任务
+    template <typename Item>
+    void run_item(Item &item, metrics_slot_t *stats)
+    {
+        if constexpr (metrics_enabled)
+        {
+            std::int64_t start = steady_now_ns();
+            stats->queue_wait.record(start - item.enqueue_ns);
+            invoke_task(item.task);
+            std::int64_t elapsed = steady_now_ns() - start;
+            stats->run_time.record(elapsed);
+            stats->busy_ns.fetch_add(static_cast<std::uint64_t>(elapsed), std::memory_order_relaxed);
+            stats->tasks.fetch_add(1, std::memory_order_relaxed);
+            finish_task();
+        }
+        else
+        {
+            (void)stats;
+            run_task(item.task);
+        }
+    }
+
+    static void invoke_task(move_only_function<void()> &task)
+    {
+#ifdef __cpp_exceptions
+        try
+        {
+#endif
+            task();
+#ifdef __cpp_exceptions
+        }
+        catch (...)
+        {
+            // 异常已在 task_with_future 中处理
+            // 这里吞没是为了防止线程崩溃
+        }
+#endif
+    }
+
+    void finish_task()
+    {
+        // 减少活跃线程计数
+        std::size_t active = m_active_threads.fetch_sub(1, std::memory_order_acq_rel) - 1;
+
+        // 完成计数归零时通知 wait()；暂停期间最后一个活跃任务结束也需通知
+        if (m_unfinished.fetch_sub(1, std::memory_order_seq_cst) == 1)
+        {
+            notify_done();
+        }
+        else if constexpr (pause_enabled)
+        {
+            if (active == 0 && m_paused.load(std::memory_order_acquire))
+                notify_done();
+        }
+    }
+
+    template <typename Item>
+    static void stamp(Item &item) noexcept
+    {
+        if constexpr (metrics_enabled)
+            item.enqueue_ns = steady_now_ns();
+        else
+            (void)item;
+    }
+
+    template <typename To, typename From>
+    static void copy_stamp(To &to, const From &from) noexcept
+    {
+        if constexpr (metrics_enabled)
+            to.enqueue_ns = from.enqueue_ns;
+        else
+        {
+            (void)to;
+            (void)from;
+        }
+    }
+
+    metrics_slot_t *register_worker_metrics(std::size_t index)
+    {
+        if constexpr (metrics_enabled)
+        {
+            auto slot = std::make_unique<worker_metrics>(index, steady_now_ns());
+            worker_metrics *raw = slot.get();
+            std::lock_guard<std::mutex> lock(m_metrics.mutex);
+            m_metrics.workers.push_back(std::move(slot));
+            return raw;
+        }
+        else
+        {
+            (void)index;
+            return nullptr;
+        }
+    }
+
+    // 从空闲恢复时更新自旋统计；生产者可能因本线程自旋而跳过唤醒，仍有积压则接力唤醒
+    void on_task_found(idle_spin_state &spin)
+    {
+        if (spin.on_task() && m_pending.load(std::memory_order_acquire) > 0)
+            wake_one();
+    }
+
+    // 仅在有线程阻塞于 wait()/wait_for() 时才加锁通知
+    void notify_done()
+    {
+        if (m_done_waiters.load(std::memory_order_seq_cst) == 0)
+            return;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_done_cv.notify_all();
+    }
+
+    [[nodiscard]] bool all_done() const
+    {
+        if (m_unfinished.load(std::memory_order_seq_cst) == 0)
+            return true;
+        if (m_active_threads.load(std::memory_order_acquire) != 0)
+            return false;
+        if (m_stop.load(std::memory_order_acquire))
+            return true;
+        if constexpr (pause_enabled)
+            return m_paused.load(std::memory_order_acquire);
+        else
+            return false;
+    }
+
+    // 空闲线程休眠前的复查条件，只读原子变量，不触碰队列锁
+    [[nodiscard]] bool has_work() const
+    {
+        if (m_stop.load(std::memory_order_acquire) ||
+            m_pending_exits.load(std::memory_order_acquire) > 0 || timers_due())
+            return true;
+        if constexpr (pause_enabled)
+        {
+            if (m_paused.load(std::memory_order_acquire))
+                return false;
+        }
+        return m_pending.load(std::memory_order_seq_cst) > 0;
+    }
+
+    // 认领一个退出请求；认领后线程不再获取 m_mutex，
+    // 因为 decrease_threads 会在持有 m_mutex 时 join 已认领退出的线程
+    bool claim_exit(std::size_t ws_slot)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_pending_exits == 0)
+            return false;
+        if constexpr (work_stealing_enabled)
+            ws_release_slot_locked(ws_slot);
+        --m_pending_exits;
+        ++m_exited_count;
+        m_exited_ids.push_back(std::this_thread::get_id());
+        m_exit_cv.notify_one();
+        return true;
+    }
+
     void stop_threads()
     {
         m_stop.store(true, std::memory_order_release);
-        m_task_queue.notify_all_consumers();
+        m_idle_event.notify_all();
         
         // 等待所有线程退出
         for (auto& t : m_threads)
@@ -1127,7 +3537,7 @@ private:
     void destroy_threads()
     {
         m_stop.store(true, std::memory_order_release);
-        m_task_queue.notify_all_consumers();
+        m_idle_event.notify_all();
         
         for (auto &t : m_threads)
         {
@@ -1137,6 +3547,15 @@ private:
     }
 #endif
 
+    [[nodiscard]] static auto pthread_self_handle() noexcept
+    {
+#if defined(__linux__)
+        return pthread_self();
+#else
+        return 0;
+#endif
+    }
+
     [[nodiscard]] static std::size_t determine_thread_count(std::size_t requested)
     {
         if (requested > 0)
@@ -1154,6 +3573,11 @@ private:
         // 设置线程本地信息
         this_thread_info::s_pool = static_cast<void*>(this);
         this_thread_info::s_index = index;
+
+        {
+            std::lock_guard<std::mutex> lock(m_options_mutex);
+            placement::apply(pthread_self_handle(), index, m_thread_options, m_cpu_plan);
+        }
         
         // 执行初始化函数
         try
@@ -1168,6 +3592,15 @@ private:
             return;
         }
 
+        std::size_t ws_slot = 0;
+        if constexpr (work_stealing_enabled)
+        {
+            ws_slot = ws_attach();
+        }
+        bool exit_claimed = false;
+        idle_spin_state spin;
+        metrics_slot_t *stats = register_worker_metrics(index);
+
         while (true)
         {
             // 检查是否需要退出
@@ -1180,95 +3613,90 @@ private:
                 break;
             }
             
-            // 检查是否有待处理的退出请求
+            // 检查是否有待处理的退出请求（先读原子计数，避免每轮都加锁）
+            if (m_pending_exits.load(std::memory_order_acquire) > 0)
             {
-                std::lock_guard<std::mutex> lock(m_mutex);
-                if (m_pending_exits > 0)
+                if constexpr (work_stealing_enabled)
+                    ws_drain(ws_slot);
+                if (claim_exit(ws_slot))
                 {
-                    --m_pending_exits;
-                    ++m_exited_count;
-                    m_exit_cv.notify_one();
+                    exit_claimed = true;
                     break;
                 }
             }
 
-            // 等待任务
-            std::optional<task_wrapper<priority_enabled>> opt_task;
-            
+            // 到期的定时任务（暂停期间同样投递，恢复后执行）
+            if (timers_due())
+                fire_due_timers();
+
+            bool paused = false;
+            if constexpr (pause_enabled)
+                paused = m_paused.load(std::memory_order_acquire);
+
+            if (!paused)
             {
-                std::unique_lock<std::mutex> lock(m_task_queue.get_mutex());
-                
-                // 等待条件
-                auto has_task = [this] {
-                    if constexpr (pause_enabled)
-                    {
-                        return m_stop.load(std::memory_order_acquire) || 
-                               (!m_paused && m_task_queue.approximate_size() > 0) ||
-                               m_pending_exits > 0;
-                    }
-                    else
+                // 本地队列与窃取
+                if constexpr (work_stealing_enabled)
+                {
+                    if (ws_task_t *local = ws_find_task(ws_slot, stats))
                     {
-                        return m_stop.load(std::memory_order_acquire) || 
-                               m_task_queue.approximate_size() > 0 ||
-                               m_pending_exits > 0;
+                        m_active_threads.fetch_add(1, std::memory_order_release);
+                        m_ws_pending.fetch_sub(1, std::memory_order_release);
+                        m_pending.fetch_sub(1, std::memory_order_release);
+                        on_task_found(spin);
+                        run_item(*local, stats);
+                        ws_node_cache::release(local);
+                        continue;
                     }
-                };
-                
-                m_task_queue.wait_for_task(lock, has_task);
-                
-                // 再次检查退出条件
-#ifdef __cpp_lib_jthread
-                if (stop_token.stop_requested() || m_stop.load(std::memory_order_acquire))
-#else
-                if (m_stop.load(std::memory_order_acquire))
-#endif
-                {
-                    break;
                 }
-                
-                // 检查暂停状态
-                if constexpr (pause_enabled)
+
+                // 全局队列：计数为零时不触碰队列锁
+                if (m_pending.load(std::memory_order_acquire) > 0)
                 {
-                    if (m_paused)
+                    if (auto opt_task = m_task_queue.get())
+                    {
+                        m_active_threads.fetch_add(1, std::memory_order_release);
+                        m_pending.fetch_sub(1, std::memory_order_release);
+                        on_task_found(spin);
+                        run_item(*opt_task, stats);
                         continue;
+                    }
                 }
-                
-                // 尝试获取任务
-                opt_task = m_task_queue.try_get();
             }
 
-            if (opt_task)
+            // 空闲：先自旋等待，预算随本线程观察到的任务间隔自适应
+            spin.on_idle();
+            if (spin_for_work(spin.budget(idle_spin())))
+                continue;
+
+            // 仍无任务：先登记为等待者再复查，生产者只在存在等待者时才唤醒
+            event_count::key_type key = m_idle_event.prepare_wait();
+            if (has_work())
             {
-                // 增加活跃线程计数
-                m_active_threads.fetch_add(1, std::memory_order_release);
-                
-                // 执行任务
-#ifdef __cpp_exceptions
-                try
-                {
-#endif
-                    opt_task->task();
-#ifdef __cpp_exceptions
-                }
-                catch (...)
-                {
-                    // 异常已在 task_with_future 中处理
-                    // 这里吞没是为了防止线程崩溃
-                }
-#endif
-                
-                // 减少活跃线程计数
-                m_active_threads.fetch_sub(1, std::memory_order_release);
-                
-                // 通知等待者
-                if (m_active_threads.load(std::memory_order_acquire) == 0)
-                {
-                    std::lock_guard<std::mutex> lock(m_mutex);
-                    m_done_cv.notify_all();
-                }
+                // 计数已增加但任务尚未入队（或窃取竞争失败），让出时间片后重试
+                m_idle_event.cancel_wait();
+                std::this_thread::yield();
+                continue;
             }
+
+            // 有定时任务时最多休眠到最早的到期时间
+            std::int64_t next_timer = m_next_timer.load(std::memory_order_seq_cst);
+            if (next_timer == no_timer)
+                m_idle_event.commit_wait(key);
+            else
+                m_idle_event.commit_wait_until(
+                    key, std::chrono::steady_clock::time_point(std::chrono::nanoseconds(next_timer)));
+        }
+
+        if constexpr (work_stealing_enabled)
+        {
+            if (!exit_claimed)
+                ws_detach(ws_slot);
         }
 
+        if constexpr (metrics_enabled)
+            stats->end_ns.store(steady_now_ns(), std::memory_order_relaxed);
+
         // 清理工作
         if (m_cleanup_func)
         {
@@ -1295,9 +3723,28 @@ private:
     std::condition_variable m_exit_cv;
 
     task_queue_t m_task_queue;
+    event_count m_idle_event;
+
+    // 定时任务最小堆与堆顶到期时间（steady_clock 纳秒，无定时任务时为 no_timer）
+    mutable std::mutex m_timer_mutex;
+    std::vector<timer_entry> m_timers;
+    std::uint64_t m_timer_seq = 0;
+    std::atomic<std::int64_t> m_next_timer{no_timer};
     
     std::atomic<size_t> m_active_threads{0};
     std::atomic<bool> m_stop{false};
+
+    // 已入队未开始的任务数 / 已提交未完成的任务数 / 阻塞在 wait() 的线程数
+    alignas(64) std::atomic<size_t> m_pending{0};
+    alignas(64) std::atomic<size_t> m_unfinished{0};
+    std::atomic<size_t> m_done_waiters{0};
+
+    // 空闲自旋：正在自旋的线程数 / 同时自旋线程数上限（硬件线程的一半）/ 自旋时间上限
+    // 单核机器上自旋只会抢占生产者的时间片，默认关闭
+    std::atomic<size_t> m_spinning{0};
+    const size_t m_max_spinners = std::max<size_t>(1, std::thread::hardware_concurrency() / 2);
+    std::atomic<std::int64_t> m_idle_spin_ns{
+        std::thread::hardware_concurrency() > 1 ? THREADPOOL_IDLE_SPIN_NS : 0};
     
     std::vector<
 #ifdef __cpp_lib_jthread
@@ -1310,11 +3757,35 @@ private:
     // 动态线程管理
     std::atomic<size_t> m_pending_exits{0};
     std::atomic<size_t> m_exited_count{0};
+    std::vector<std::thread::id> m_exited_ids;
+
+    // work_stealing：每个工作线程一个 Chase-Lev 双端队列，槽位由 m_mutex 保护
+    std::unique_ptr<std::unique_ptr<ws_deque_t>[]> m_ws_deques{
+        work_stealing_enabled ? new std::unique_ptr<ws_deque_t>[max_ws_workers] : nullptr};
+    std::vector<bool> m_ws_slot_used = std::vector<bool>(work_stealing_enabled ? max_ws_workers : 0, false);
+    std::atomic<size_t> m_ws_slot_count{0};
+    std::atomic<size_t> m_ws_pending{0};
 
     move_only_function<void(std::size_t)> m_init_func = [](std::size_t) {};
     move_only_function<void(std::size_t)> m_cleanup_func = [](std::size_t) {};
 
-    std::conditional_t<pause_enabled, bool, std::monostate> m_paused = {};
+    // 运行指标（仅 tp_flag::metrics）
+    mutable std::conditional_t<metrics_enabled, metrics_registry, std::monostate> m_metrics;
+
+    // 队列溢出策略与统计
+    std::atomic<overflow_policy> m_overflow_policy{overflow_policy::block};
+    std::atomic<std::int64_t> m_block_timeout_ns{std::chrono::nanoseconds::max().count()};
+    std::atomic<std::uint64_t> m_blocked_count{0};
+    std::atomic<std::uint64_t> m_rejected_count{0};
+    std::atomic<std::uint64_t> m_dropped_count{0};
+    std::atomic<std::uint64_t> m_caller_ran_count{0};
+
+    // 工作线程放置参数与按策略排好的 CPU 列表
+    mutable std::mutex m_options_mutex;
+    thread_options m_thread_options;
+    std::vector<std::vector<int>> m_cpu_plan;
+
+    std::conditional_t<pause_enabled, std::atomic<bool>, std::monostate> m_paused{};
 };
 
 // ============================================================================
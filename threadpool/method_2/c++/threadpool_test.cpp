@@ -0,0 +1,213 @@
+/***************************************************************
+Copyright (c) 2022-2030, shisan233@sszc.live.
+SPDX-License-Identifier: MIT
+File:        threadpool_test.cpp
+Version:     1.0
+Author:      cjx
+start date: 2026-10-18
+Description: ThreadPool 有界队列下的功能测试
+             覆盖 drop_oldest / purge 丢弃 schedule() 作业时协程仍被恢复，
+             周期定时任务的某次投递被拒绝或丢弃后仍按周期继续
+             编译运行：g++ -std=c++20 -O1 threadpool_test.cpp -o threadpool_test -pthread && ./threadpool_test
+Version history
+
+[序号]    |   [修改日期]  |   [修改者]   |   [修改内容]
+1            2026-10-18       cjx         create
+2            2026-10-18       cjx         有界队列下的周期定时任务测试
+
+*****************************************************************/
+
+#include "threadpool.hpp"
+#include "coroutine.hpp"
+
+#include <cstdio>
+#include <future>
+
+using clock_type = std::chrono::steady_clock;
+using std::chrono::milliseconds;
+
+// ============================================================================
+// 测试工具
+// ============================================================================
+
+static int g_failures = 0;
+
+#define CHECK(cond)                                                             \
+    do                                                                          \
+    {                                                                           \
+        if (!(cond))                                                            \
+        {                                                                       \
+            std::printf("  FAILED %s:%d: %s\n", __FILE__, __LINE__, #cond);     \
+            g_failures++;                                                       \
+        }                                                                       \
+    } while (0)
+
+template <typename Pred>
+static bool wait_until(Pred pred, milliseconds timeout = milliseconds(2000))
+{
+    auto deadline = clock_type::now() + timeout;
+    while (!pred())
+    {
+        if (clock_type::now() >= deadline)
+            return false;
+        std::this_thread::sleep_for(milliseconds(2));
+    }
+    return true;
+}
+
+// 占住全部工作线程，直到 release 置位
+template <typename Pool>
+static void occupy_workers(Pool &pool, std::size_t workers, std::atomic<bool> &release)
+{
+    std::atomic<std::size_t> started{0};
+    for (std::size_t i = 0; i < workers; ++i)
+    {
+        pool.detach([&started, &release] {
+            started++;
+            while (!release.load())
+                std::this_thread::sleep_for(milliseconds(1));
+        });
+    }
+    wait_until([&] { return started.load() == workers; });
+}
+
+// ============================================================================
+// 协程
+// ============================================================================
+
+#ifdef THREADPOOL_HAS_COROUTINE
+
+static coro::task<> hop(DefaultThreadPool &pool, std::atomic<int> &resumed)
+{
+    co_await pool.schedule();
+    resumed++;
+}
+
+static void test_schedule_drop_oldest()
+{
+    std::printf("schedule() survives drop_oldest eviction\n");
+    DefaultThreadPool pool(1);
+    std::atomic<bool> release{false};
+    occupy_workers(pool, 1, release);
+    pool.set_queue_limit(2, overflow_policy::drop_oldest);
+
+    // 5 个协程依次入队，容量 2：前 3 个的恢复作业被后来者挤出，须在丢弃处恢复
+    std::atomic<int> resumed{0};
+    std::vector<std::future<void>> waiters;
+    for (int i = 0; i < 5; ++i)
+    {
+        waiters.push_back(std::async(std::launch::async, [&] { coro::sync_wait(hop(pool, resumed)); }));
+        std::size_t queued = std::min(i + 1, 2);
+        int evicted = std::max(i - 1, 0);
+        CHECK(wait_until([&] { return pool.queued_tasks() == queued && resumed.load() == evicted; }));
+    }
+    CHECK(wait_until([&] { return resumed.load() == 3; }));
+    CHECK(pool.get_queue_stats().dropped == 3);
+
+    release = true;
+    for (auto &w : waiters)
+        CHECK(w.wait_for(std::chrono::seconds(2)) == std::future_status::ready);
+    CHECK(resumed.load() == 5);
+}
+
+static void test_schedule_purge()
+{
+    std::printf("schedule() survives purge\n");
+    DefaultThreadPool pool(1);
+    std::atomic<bool> release{false};
+    occupy_workers(pool, 1, release);
+    pool.set_queue_limit(4, overflow_policy::reject);
+
+    std::atomic<int> resumed{0};
+    std::vector<std::future<void>> waiters;
+    for (int i = 0; i < 3; ++i)
+        waiters.push_back(std::async(std::launch::async, [&] { coro::sync_wait(hop(pool, resumed)); }));
+    CHECK(wait_until([&] { return pool.queued_tasks() == 3; }));
+
+    // 清除的恢复作业在 purge 所在线程恢复协程
+    pool.purge();
+    CHECK(resumed.load() == 3);
+    for (auto &w : waiters)
+        CHECK(w.wait_for(std::chrono::seconds(2)) == std::future_status::ready);
+    release = true;
+    pool.wait();
+}
+
+#endif
+
+// ============================================================================
+// 定时任务
+// ============================================================================
+
+static void test_every_survives_reject()
+{
+    std::printf("schedule_every survives a rejected tick\n");
+    DefaultThreadPool pool(1);
+    std::atomic<bool> release{false};
+    occupy_workers(pool, 1, release);
+    pool.set_queue_limit(1, overflow_policy::reject);
+
+    // 队列被占满后定时任务到期，工作线程空出时投递被拒绝
+    std::atomic<int> ticks{0};
+    auto timer = pool.schedule_every(milliseconds(10), [&ticks] { ticks++; });
+    pool.detach([] {});
+    std::this_thread::sleep_for(milliseconds(30));
+    release = true;
+
+    CHECK(wait_until([&] { return pool.get_queue_stats().rejected >= 1; }));
+    CHECK(wait_until([&] { return ticks.load() >= 3; }));
+    CHECK(pool.pending_timers() == 1);
+    timer.cancel();
+}
+
+static void test_every_survives_drop_oldest()
+{
+    std::printf("schedule_every survives drop_oldest eviction\n");
+    DefaultThreadPool pool(1);
+    std::atomic<bool> release{false};
+    occupy_workers(pool, 1, release);
+    pool.set_queue_limit(2, overflow_policy::drop_oldest);
+
+    // 工作线程空出时先投递定时作业，再去执行排在它前面的长任务
+    std::atomic<bool> filler_started{false};
+    std::atomic<bool> filler_release{false};
+    pool.detach([&] {
+        filler_started = true;
+        while (!filler_release.load())
+            std::this_thread::sleep_for(milliseconds(1));
+    });
+    std::atomic<int> ticks{0};
+    auto timer = pool.schedule_every(milliseconds(10), [&ticks] { ticks++; });
+    std::this_thread::sleep_for(milliseconds(30));
+    release = true;
+    CHECK(wait_until([&] { return filler_started.load() && pool.queued_tasks() == 1; }));
+
+    // 再提交两个任务，排队中的定时作业被挤出
+    pool.detach([] {});
+    pool.detach([] {});
+    CHECK(pool.get_queue_stats().dropped == 1);
+    CHECK(ticks.load() == 0);
+    CHECK(pool.pending_timers() == 1);
+
+    filler_release = true;
+    CHECK(wait_until([&] { return ticks.load() >= 3; }));
+    timer.cancel();
+}
+
+int main()
+{
+#ifdef THREADPOOL_HAS_COROUTINE
+    test_schedule_drop_oldest();
+    test_schedule_purge();
+#endif
+    test_every_survives_reject();
+    test_every_survives_drop_oldest();
+
+    if (g_failures > 0)
+    {
+        std::printf("%d check(s) failed\n", g_failures);
+        return 1;
+    }
+    std::printf("all passed\n");
+    return 0;
+}
@@ -1,6 +1,7 @@
 #include "threadpool.h"
 
 #include <errno.h>
+#include <stddef.h>
 #include <stdlib.h>
 
 
@@ -92,6 +93,38 @@ void taskqueue_put(void *task, taskqueue_t *queue)
 	pthread_mutex_unlock(&queue->put_mutex);
 	pthread_cond_signal(&queue->get_cond);
 }
+// 放入预先串好的任务链，一次加锁完成
+size_t taskqueue_put_list(void *head, taskqueue_t *queue)
+{
+	void **first;
+	void **link;
+	void *next;
+	size_t cnt = 1;
+
+	if (!head)
+		return 0;
+
+	// 调用方的链接字段保存下一个任务的地址，在锁外改写为队列内部使用的链接字段地址
+	first = (void **)((char *)head + queue->linkoff);
+	link = first;
+	while ((next = *link) != NULL)
+	{
+		*link = (char *)next + queue->linkoff;
+		link = (void **)*link;
+		cnt++;
+	}
+
+	pthread_mutex_lock(&queue->put_mutex);
+	while (queue->taskNum > queue->queue_maxsize - 1 && !queue->nonblock)
+		pthread_cond_wait(&queue->put_cond, &queue->put_mutex);
+
+	*queue->put_tail = first;
+	queue->put_tail = link;
+	queue->taskNum += cnt;
+	pthread_mutex_unlock(&queue->put_mutex);
+	pthread_cond_signal(&queue->get_cond);
+	return cnt;
+}
 // 从队列头放入任务
 void taskqueue_put_head(void *task, taskqueue_t *queue)
 {
@@ -160,24 +193,311 @@ void *taskqueue_get(taskqueue_t *queue)
 	pthread_mutex_unlock(&queue->get_mutex);
 	return task;
 }
+// 批量获取任务：一次加锁最多取出 max 个，消费链表不足时只取现有部分，不再等待
+size_t taskqueue_get_batch(taskqueue_t *queue, void **tasks, size_t max)
+{
+	void **link;
+	size_t cnt = 0;
+
+	if (max == 0)
+		return 0;
+
+	pthread_mutex_lock(&queue->get_mutex);
+	if (*queue->get_head || __taskqueue_swap(queue) > 0)
+	{
+		link = (void **)*queue->get_head;
+		do
+		{
+			tasks[cnt++] = (char *)link - queue->linkoff;
+			link = (void **)*link;
+		} while (link && cnt < max);
+
+		*queue->get_head = link;
+	}
+
+	pthread_mutex_unlock(&queue->get_mutex);
+	return cnt;
+}
 
 
 ///////////*//////////      线程池相关操作接口封装     //////////*///////////
 
-struct __threadpool_task_entry
+///////////*//////////      任务节点缓存     //////////*///////////
+
+// 每个线程缓存一批空闲节点，超出上限时整批归还到全局仓库，取空时整批取回；
+// 生产线程分配、工作线程释放的场景下，每 __ENTRY_BATCH 个任务才访问一次全局锁
+#define __ENTRY_BATCH		64
+#define __ENTRY_DEPOT_MAX	256		// 仓库最多保留的批次数，超出直接释放
+
+struct __threadpool_entry_cache
+{
+	struct threadpool_task_node *head;	// 空闲节点链表（经 link 串联）
+	size_t count;						// 空闲节点数
+	int registered;						// 已注册线程退出时的回收
+};
+
+static __thread struct __threadpool_entry_cache __entry_cache;
+
+// 仓库中每个批次为 __ENTRY_BATCH 个节点的链表，批次之间经批首节点的 task.data 串联
+static pthread_mutex_t __entry_depot_mutex = PTHREAD_MUTEX_INITIALIZER;
+static struct threadpool_task_node *__entry_depot;
+static size_t __entry_depot_batches;
+
+static pthread_once_t __entry_key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t __entry_key;
+
+// 归还一个整批，仓库已满时直接释放
+static void __entry_depot_put(struct threadpool_task_node *batch)
+{
+	struct threadpool_task_node *next;
+
+	pthread_mutex_lock(&__entry_depot_mutex);
+	if (__entry_depot_batches < __ENTRY_DEPOT_MAX)
+	{
+		batch->task.data = __entry_depot;
+		__atomic_store_n(&__entry_depot, batch, __ATOMIC_RELAXED);
+		__entry_depot_batches++;
+		batch = NULL;
+	}
+	pthread_mutex_unlock(&__entry_depot_mutex);
+
+	while (batch)
+	{
+		next = (struct threadpool_task_node *)batch->link;
+		free(batch);
+		batch = next;
+	}
+}
+// 从本线程缓存头部切下一整批归还到仓库
+static void __entry_cache_release_batch(struct __threadpool_entry_cache *cache)
+{
+	struct threadpool_task_node *batch = cache->head;
+	struct threadpool_task_node *tail = batch;
+	size_t i;
+
+	for (i = 1; i < __ENTRY_BATCH; i++)
+		tail = (struct threadpool_task_node *)tail->link;
+
+	cache->head = (struct threadpool_task_node *)tail->link;
+	cache->count -= __ENTRY_BATCH;
+	tail->link = NULL;
+	__entry_depot_put(batch);
+}
+// 线程退出时把本线程缓存的节点按整批归还，不足一批的直接释放
+static void __entry_cache_flush(void *arg)
+{
+	struct __threadpool_entry_cache *cache = (struct __threadpool_entry_cache *)arg;
+	struct threadpool_task_node *entry;
+
+	while (cache->count >= __ENTRY_BATCH)
+		__entry_cache_release_batch(cache);
+
+	while (cache->head)
+	{
+		entry = cache->head;
+		cache->head = (struct threadpool_task_node *)entry->link;
+		free(entry);
+	}
+
+	cache->count = 0;
+	cache->registered = 0;
+}
+
+static void __entry_key_create(void)
+{
+	pthread_key_create(&__entry_key, __entry_cache_flush);
+}
+// 首次缓存节点前注册线程退出回收，失败时本线程不缓存
+static int __entry_cache_register(struct __threadpool_entry_cache *cache)
+{
+	if (!cache->registered)
+	{
+		pthread_once(&__entry_key_once, __entry_key_create);
+		if (pthread_setspecific(__entry_key, cache) != 0)
+			return -1;
+
+		cache->registered = 1;
+	}
+
+	return 0;
+}
+// 分配任务节点：本线程缓存 -> 全局仓库整批取回 -> malloc
+static struct threadpool_task_node *__entry_alloc(void)
+{
+	struct __threadpool_entry_cache *cache = &__entry_cache;
+	struct threadpool_task_node *entry = cache->head;
+
+	if (!entry && __atomic_load_n(&__entry_depot, __ATOMIC_RELAXED) &&
+		__entry_cache_register(cache) == 0)
+	{
+		pthread_mutex_lock(&__entry_depot_mutex);
+		entry = __entry_depot;
+		if (entry)
+		{
+			__atomic_store_n(&__entry_depot, (struct threadpool_task_node *)entry->task.data, __ATOMIC_RELAXED);
+			__entry_depot_batches--;
+			cache->count = __ENTRY_BATCH;
+		}
+		pthread_mutex_unlock(&__entry_depot_mutex);
+	}
+
+	if (entry)
+	{
+		cache->head = (struct threadpool_task_node *)entry->link;
+		cache->count--;
+	}
+	else
+		entry = (struct threadpool_task_node *)malloc(sizeof (struct threadpool_task_node));
+
+	return entry;
+}
+// 释放任务节点到本线程缓存，缓存达到两批时归还一批
+static void __entry_free(struct threadpool_task_node *entry)
+{
+	struct __threadpool_entry_cache *cache = &__entry_cache;
+
+	if (__entry_cache_register(cache) < 0)
+	{
+		free(entry);
+		return;
+	}
+
+	entry->link = cache->head;
+	cache->head = entry;
+	if (++cache->count >= 2 * __ENTRY_BATCH)
+		__entry_cache_release_batch(cache);
+}
+
+///////////*//////////      线程池内部实现     //////////*///////////
+
+// 工作线程每次加锁最多取出的任务数；取得过多会让耗时任务积压在单个线程上
+#define __THREADPOOL_BATCH	8
+
+// 工作线程已取出但尚未执行的任务
+struct __threadpool_batch
 {
-	void *link;                         // 任务的链接
-	struct threadpool_task task;        // 任务本身
+	void *task[__THREADPOOL_BATCH];
+	size_t pos;						// 下一个待执行的位置
+	size_t cnt;						// 取出的任务数
+	taskqueue_t *queue;				// 任务来源队列
+	size_t shard;					// 分片模式下本线程所属的分片
 };
 
+static __thread struct __threadpool_batch __worker_batch;
+
 static pthread_t __zero_tid;
 
+// 分片模式下唤醒一个空闲的工作线程
+static void __threadpool_notify_idle(threadpool_t *pool)
+{
+	if (pool->shards && __atomic_load_n(&pool->nidle, __ATOMIC_SEQ_CST) > 0)
+	{
+		pthread_mutex_lock(&pool->idle_mutex);
+		pthread_cond_signal(&pool->idle_cond);
+		pthread_mutex_unlock(&pool->idle_mutex);
+	}
+}
+// 选择投递队列：池内线程投递到自己的分片，外部线程轮询各分片
+static taskqueue_t *__threadpool_pick_queue(threadpool_t *pool)
+{
+	size_t idx;
+
+	if (!pool->shards)
+		return pool->taskqueue;
+
+	if (pthread_getspecific(pool->key) == pool)
+		idx = __worker_batch.shard;
+	else
+		idx = __atomic_fetch_add(&pool->next_shard, 1, __ATOMIC_RELAXED) % pool->nshards;
+
+	return pool->shards[idx];
+}
+// 放入任务并按需唤醒空闲线程
+static void __threadpool_put(struct threadpool_task_node *node, int head, threadpool_t *pool)
+{
+	taskqueue_t *queue = __threadpool_pick_queue(pool);
+
+	if (head)
+		taskqueue_put_head(node, queue);
+	else
+		taskqueue_put(node, queue);
+
+	__threadpool_notify_idle(pool);
+}
+// 线程退出或在池内销毁前，把本线程未执行的任务按原顺序放回来源队列头
+static void __threadpool_return_batch(threadpool_t *pool)
+{
+	struct __threadpool_batch *batch = &__worker_batch;
+	int returned = batch->cnt > batch->pos;
+
+	while (batch->cnt > batch->pos)
+		taskqueue_put_head(batch->task[--batch->cnt], batch->queue);
+
+	batch->pos = 0;
+	batch->cnt = 0;
+	if (returned)
+		__threadpool_notify_idle(pool);
+}
+// 依次尝试本线程分片与其他分片，窃取时只取半批，避免把耗时任务集中到一个线程
+static size_t __threadpool_scan_shards(threadpool_t *pool, struct __threadpool_batch *batch)
+{
+	taskqueue_t *queue;
+	size_t cnt;
+	size_t i;
+
+	for (i = 0; i < pool->nshards; i++)
+	{
+		queue = pool->shards[(batch->shard + i) % pool->nshards];
+		cnt = taskqueue_get_batch(queue, batch->task,
+								  i == 0 ? __THREADPOOL_BATCH : __THREADPOOL_BATCH / 2);
+		if (cnt > 0)
+		{
+			batch->queue = queue;
+			return cnt;
+		}
+	}
+
+	return 0;
+}
+// 取一批任务：单队列模式阻塞在队列上；分片模式全部分片为空时在 idle_cond 上休眠
+static size_t __threadpool_fetch(threadpool_t *pool, struct __threadpool_batch *batch)
+{
+	size_t cnt;
+
+	if (!pool->shards)
+	{
+		batch->queue = pool->taskqueue;
+		return taskqueue_get_batch(pool->taskqueue, batch->task, __THREADPOOL_BATCH);
+	}
+
+	while (1)
+	{
+		cnt = __threadpool_scan_shards(pool, batch);
+		if (cnt > 0 || pool->terminate)
+			return cnt;
+
+		// 先登记空闲再复查：投递方放入任务后看到 nidle > 0 才会加锁唤醒
+		pthread_mutex_lock(&pool->idle_mutex);
+		__atomic_add_fetch(&pool->nidle, 1, __ATOMIC_SEQ_CST);
+		cnt = __threadpool_scan_shards(pool, batch);
+		if (cnt == 0 && !pool->terminate)
+			pthread_cond_wait(&pool->idle_cond, &pool->idle_mutex);
+
+		__atomic_sub_fetch(&pool->nidle, 1, __ATOMIC_SEQ_CST);
+		pthread_mutex_unlock(&pool->idle_mutex);
+		if (cnt > 0)
+			return cnt;
+	}
+}
+
 // 线程退出时执行的函数。它会减少线程池中的线程计数，并在所有线程退出后通知主线程
 static void __threadpool_exit_routine(void *context)
 {
 	threadpool_t *pool = (threadpool_t *)context;
 	pthread_t tid;
 
+	__threadpool_return_batch(pool);
+
 	/* One thread joins another. Don't need to keep all thread IDs. */
 	pthread_mutex_lock(&pool->mutex);
 	tid = pool->tid;
@@ -195,26 +515,39 @@ static void __threadpool_exit_routine(void *context)
 static void *__threadpool_routine(void *arg)
 {
 	threadpool_t *pool = (threadpool_t *)arg;
-	struct __threadpool_task_entry *entry;
+	struct __threadpool_batch *batch = &__worker_batch;
+	struct threadpool_task_node *entry;
 	void (*task_routine)(void *);
 	void *task_context;
 
 	pthread_setspecific(pool->key, pool);
+	if (pool->shards)
+		batch->shard = __atomic_fetch_add(&pool->next_worker, 1, __ATOMIC_RELAXED) % pool->nshards;
+
 	while (!pool->terminate)
 	{
-		entry = (struct __threadpool_task_entry *)taskqueue_get(pool->taskqueue);
-		if (!entry)
+		batch->cnt = __threadpool_fetch(pool, batch);
+		batch->pos = 0;
+		if (batch->cnt == 0)
 			break;
 
-		task_routine = entry->task.routine;
-		task_context = entry->task.data;
-		free(entry);
-		task_routine(task_context);		// 执行任务
-
-		if (pool->nthreads == 0)
+		while (batch->pos < batch->cnt)
 		{
-			free(pool);
-			return NULL;
+			entry = (struct threadpool_task_node *)batch->task[batch->pos++];
+			task_routine = entry->task.routine;
+			task_context = entry->task.data;
+			if (entry->pooled)
+				__entry_free(entry);
+			task_routine(task_context);		// 执行任务
+
+			if (pool->nthreads == 0)
+			{
+				free(pool);
+				return NULL;
+			}
+
+			if (pool->terminate)
+				break;
 		}
 	}
 
@@ -229,6 +562,12 @@ static void __threadpool_terminate(int in_pool, threadpool_t *pool)
 	pthread_mutex_lock(&pool->mutex);
 	taskqueue_set_nonblock(pool->taskqueue);
 	pool->terminate = &term;
+	if (pool->shards)
+	{
+		pthread_mutex_lock(&pool->idle_mutex);
+		pthread_cond_broadcast(&pool->idle_cond);
+		pthread_mutex_unlock(&pool->idle_mutex);
+	}
 
 	if (in_pool)
 	{
@@ -276,19 +615,48 @@ static int __threadpool_create_threads(size_t nthreads, threadpool_t *pool)
 	errno = ret;
 	return -1;
 }
-// 实际创建函数（内部使用）
-static threadpool_t *__threadpool_create_with_queue(size_t nthreads, size_t stacksize, taskqueue_t *taskqueue)
+// 释放线程池持有的任务队列
+static void __threadpool_destroy_queues(threadpool_t *pool)
+{
+	size_t i;
+
+	if (!pool->shards)
+	{
+		taskqueue_destroy(pool->taskqueue);
+		return;
+	}
+
+	for (i = 0; i < pool->nshards; i++)
+		taskqueue_destroy(pool->shards[i]);
+
+	free(pool->shards);
+}
+// 实际创建函数（内部使用，shards 非空时为分片模式，taskqueue 为 shards[0]）
+static threadpool_t *__threadpool_create_with_queue(size_t nthreads, size_t stacksize, taskqueue_t *taskqueue,
+													taskqueue_t **shards, size_t nshards)
 {
+    threadpool_t *pool = NULL;
+    int ret = 0;
+
     if (!taskqueue) return NULL;
 
-    threadpool_t *pool = (threadpool_t *)malloc(sizeof(threadpool_t));
+    pool = (threadpool_t *)malloc(sizeof(threadpool_t));
     if (!pool) {
-        taskqueue_destroy(taskqueue);
+        if (shards) {
+            for (size_t i = 0; i < nshards; i++)
+                taskqueue_destroy(shards[i]);
+            free(shards);
+        } else
+            taskqueue_destroy(taskqueue);
         return NULL;
     }
 
-    int ret;
     pool->taskqueue = taskqueue;
+    pool->shards = shards;
+    pool->nshards = nshards;
+    pool->next_shard = 0;
+    pool->next_worker = 0;
+    pool->nidle = 0;
     pool->stacksize = stacksize;
     pool->nthreads = 0;
     pool->tid = __zero_tid;
@@ -297,6 +665,12 @@ static threadpool_t *__threadpool_create_with_queue(size_t nthreads, size_t stac
     ret = pthread_mutex_init(&pool->mutex, NULL);
     if (ret != 0) goto error;
 
+    ret = pthread_mutex_init(&pool->idle_mutex, NULL);
+    if (ret != 0) goto error;
+
+    ret = pthread_cond_init(&pool->idle_cond, NULL);
+    if (ret != 0) goto error;
+
     ret = pthread_key_create(&pool->key, NULL);
     if (ret != 0) goto error;
 
@@ -309,8 +683,10 @@ error:
     errno = ret;
     if (pool) {
         pthread_key_delete(pool->key);
+        pthread_cond_destroy(&pool->idle_cond);
+        pthread_mutex_destroy(&pool->idle_mutex);
         pthread_mutex_destroy(&pool->mutex);
-        taskqueue_destroy(pool->taskqueue);
+        __threadpool_destroy_queues(pool);
         free(pool);
     }
     return NULL;
@@ -319,12 +695,47 @@ error:
 // 用户调用的函数，创建并初始化一个新的线程池，包括消息队列和互斥锁
 threadpool_t *threadpool_create(size_t nthreads, size_t stacksize)
 {
-	return __threadpool_create_with_queue(nthreads, stacksize, taskqueue_create(0, 0));
+	return __threadpool_create_with_queue(nthreads, stacksize,
+				taskqueue_create(0, offsetof(struct threadpool_task_node, link)), NULL, 0);
+}
+// 创建分片线程池：每个工作线程绑定一个分片队列，空闲时窃取其他分片的任务
+threadpool_t *threadpool_create_sharded(size_t nthreads, size_t nqueues, size_t stacksize)
+{
+	taskqueue_t **shards;
+	size_t i;
+
+	if (nqueues == 0)
+		nqueues = nthreads ? nthreads : 1;
+
+	shards = (taskqueue_t **)malloc(nqueues * sizeof (taskqueue_t *));
+	if (!shards)
+		return NULL;
+
+	for (i = 0; i < nqueues; i++)
+	{
+		shards[i] = taskqueue_create(0, offsetof(struct threadpool_task_node, link));
+		if (!shards[i])
+			break;
+
+		// 分片队列不在队列上阻塞，空闲等待统一由 idle_cond 负责
+		taskqueue_set_nonblock(shards[i]);
+	}
+
+	if (i < nqueues)
+	{
+		while (i > 0)
+			taskqueue_destroy(shards[--i]);
+
+		free(shards);
+		return NULL;
+	}
+
+	return __threadpool_create_with_queue(nthreads, stacksize, shards[0], shards, nqueues);
 }
 // 重新绑定新的任务队列
 void threadpool_swap_taskqueue(threadpool_t *pool, taskqueue_t *taskqueue)
 {
-	if (!taskqueue || !pool) return;
+	if (!taskqueue || !pool || pool->shards) return;
 
     pthread_mutex_lock(&pool->mutex);
     
@@ -334,7 +745,7 @@ void threadpool_swap_taskqueue(threadpool_t *pool, taskqueue_t *taskqueue)
     pthread_t tid = pool->tid;
     
     // 创建新线程池
-    threadpool_t *new_pool = __threadpool_create_with_queue(nthreads, stacksize, taskqueue);
+    threadpool_t *new_pool = __threadpool_create_with_queue(nthreads, stacksize, taskqueue, NULL, 0);
     if (!new_pool) {
         pthread_mutex_unlock(&pool->mutex);
         return;
@@ -360,17 +771,24 @@ void threadpool_swap_taskqueue(threadpool_t *pool, taskqueue_t *taskqueue)
 // 用户调用的函数，分配任务到线程池
 int threadpool_schedule(const struct threadpool_task *task, threadpool_t *pool)
 {
-	void *buf = malloc(sizeof (struct __threadpool_task_entry));
+	struct threadpool_task_node *entry = __entry_alloc();
 
-	if (buf)
+	if (entry)
 	{
-		((struct __threadpool_task_entry *)buf)->task = *task;
-		taskqueue_put(buf, pool->taskqueue);
+		entry->task = *task;
+		entry->pooled = 1;
+		__threadpool_put(entry, 0, pool);
 		return 0;
 	}
 
 	return -1;
 }
+// 添加侵入式任务，节点由调用方提供
+void threadpool_schedule_intrusive(struct threadpool_task_node *node, threadpool_t *pool)
+{
+	node->pooled = 0;
+	__threadpool_put(node, 0, pool);
+}
 // 检查当前线程是否在线程池中
 int threadpool_in_pool(threadpool_t *pool)
 {
@@ -406,15 +824,14 @@ int threadpool_increase(threadpool_t *pool)
 // 减少线程池中的线程数量(通过添加一个停止当前线程的任务到线程池中，并减少线程池计数)
 int threadpool_decrease(threadpool_t *pool)
 {
-	void *buf = malloc(sizeof (struct __threadpool_task_entry));
-	struct __threadpool_task_entry *entry;
+	struct threadpool_task_node *entry = __entry_alloc();
 
-	if (buf)
+	if (entry)
 	{
-		entry = (struct __threadpool_task_entry *)buf;
+		entry->pooled = 1;
 		entry->task.routine = __threadpool_exit_routine;
 		entry->task.data = pool;
-		taskqueue_put_head(entry, pool->taskqueue);
+		__threadpool_put(entry, 1, pool);
 		return 0;
 	}
 
@@ -430,24 +847,38 @@ void threadpool_exit(threadpool_t *pool)
 void threadpool_destroy(void (*pending)(const threadpool_task *), threadpool_t *pool)
 {
 	int in_pool = threadpool_in_pool(pool);
-	struct __threadpool_task_entry *entry;
+	struct threadpool_task_node *entry;
+	size_t nqueues = pool->shards ? pool->nshards : 1;
+	size_t i;
+	int pooled;
+
+	if (in_pool)
+		__threadpool_return_batch(pool);
 
 	__threadpool_terminate(in_pool, pool);
-	while (1)
+	for (i = 0; i < nqueues; i++)
 	{
-		entry = (struct __threadpool_task_entry *)taskqueue_get(pool->taskqueue);
-		if (!entry)
-			break;
+		while (1)
+		{
+			entry = (struct threadpool_task_node *)taskqueue_get(pool->shards ? pool->shards[i] : pool->taskqueue);
+			if (!entry)
+				break;
 
-		if (pending && entry->task.routine != __threadpool_exit_routine)
-			pending(&entry->task);
+			// pending 可能释放调用方提供的侵入式节点，之后不能再访问 entry
+			pooled = entry->pooled;
+			if (pending && entry->task.routine != __threadpool_exit_routine)
+				pending(&entry->task);
 
-		free(entry);
+			if (pooled)
+				__entry_free(entry);
+		}
 	}
 
 	pthread_key_delete(pool->key);
+	pthread_cond_destroy(&pool->idle_cond);
+	pthread_mutex_destroy(&pool->idle_mutex);
 	pthread_mutex_destroy(&pool->mutex);
-	taskqueue_destroy(pool->taskqueue);
+	__threadpool_destroy_queues(pool);
 	if (!in_pool)
 		free(pool);
 }
\ No newline at end of file
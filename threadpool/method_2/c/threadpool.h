@@ -10,6 +10,9 @@ Version history
 
 [序号]    |   [修改日期]  |   [修改者]   |   [修改内容]
 1            2024-12-31       cjx         create
+2            2026-10-18       cjx         任务节点改为线程缓存复用，新增侵入式调度接口
+3            2026-10-18       cjx         新增批量取任务与任务链放入接口，工作线程批量取任务
+4            2026-10-18       cjx         新增分片模式：每个工作线程绑定一个任务队列，空闲时窃取
 
 *****************************************************************/
 
@@ -44,7 +47,14 @@ struct threadpool_t
     pthread_mutex_t mutex;      // 互斥锁
     pthread_key_t key;          // 线程私有数据识别标记
     pthread_cond_t *terminate;  // 线程间同步的条件变量（终止）
-    taskqueue_t *taskqueue;     // 任务队列
+    taskqueue_t *taskqueue;     // 任务队列（分片模式下为第一个分片）
+    taskqueue_t **shards;       // 分片任务队列（非分片模式为NULL）
+    size_t nshards;             // 分片数
+    size_t next_shard;          // 外部线程轮询投递的位置
+    size_t next_worker;         // 工作线程绑定分片的计数
+    size_t nidle;               // 分片模式下休眠的工作线程数
+    pthread_mutex_t idle_mutex; // 空闲等待的互斥锁
+    pthread_cond_t idle_cond;   // 空闲等待的条件变量
 };
 
 struct threadpool_task
@@ -53,6 +63,15 @@ struct threadpool_task
     void *data;                 // 上函数的入参（由用户自定义入参）
 };
 
+// 任务队列中的任务节点：threadpool_schedule 内部分配，
+// 侵入式调度时由调用方嵌入自己的结构体，节点在 routine 开始执行前不可复用或释放
+struct threadpool_task_node
+{
+    void *link;                 // 队列链接（内部使用）
+    struct threadpool_task task;// 任务本身
+    int pooled;                 // 是否由线程池分配（内部使用）
+};
+
 
 ///////////*//////////     api    //////////*///////////
 #ifdef __cplusplus
@@ -64,8 +83,12 @@ extern "C"
 taskqueue_t *taskqueue_create(size_t maxlen, int linkoff);
 // 获取任务
 void *taskqueue_get(taskqueue_t *queue);
+// 批量获取任务（一次加锁最多取出max个，返回取出的数量，0表示队列已设为非阻塞且为空）
+size_t taskqueue_get_batch(taskqueue_t *queue, void **tasks, size_t max);
 // 放入任务
 void taskqueue_put(void *msg, taskqueue_t *queue);
+// 放入任务链（各任务链接字段存放下一个任务的地址，以NULL结尾；一次加锁，返回放入的数量）
+size_t taskqueue_put_list(void *head, taskqueue_t *queue);
 // 从队列头放入任务
 void taskqueue_put_head(void *msg, taskqueue_t *queue);
 // 队列设置为非阻塞模式（队列无限增长）
@@ -77,10 +100,14 @@ void taskqueue_destroy(taskqueue_t *queue);
 
 // 创建线程池（系统默认分配栈，stacksize传0）)(绑定的任务队列默认为非阻塞)
 threadpool_t *threadpool_create(size_t nthreads, size_t stacksize);
-// 修改线程池绑定任务队列(taskqueue传null，不做任何操作)
+// 创建分片线程池（nqueues传0时与线程数相同；池内线程投递到自己的分片，外部线程轮询分片，空闲线程窃取其他分片）
+threadpool_t *threadpool_create_sharded(size_t nthreads, size_t nqueues, size_t stacksize);
+// 修改线程池绑定任务队列(taskqueue传null或分片线程池，不做任何操作)
 void threadpool_swap_taskqueue(threadpool_t *pool, taskqueue_t *taskqueue);
 // 添加任务
 int threadpool_schedule(const struct threadpool_task *task, threadpool_t *pool);
+// 添加侵入式任务（node->task 需已填好，不分配内存；destroy 时未执行的节点同样交给 pending 处理，pending 中可释放节点）
+void threadpool_schedule_intrusive(struct threadpool_task_node *node, threadpool_t *pool);
 // 检查当前线程
 int threadpool_in_pool(threadpool_t *pool);
 // 增加线程池线程数
@@ -0,0 +1,109 @@
+/***************************************************************
+Copyright (c) 2022-2030, shisan233@sszc.live.
+SPDX-License-Identifier: MIT
+File:        threadpool_test.cc
+Version:     1.0
+Author:      cjx
+start date: 2026-10-18
+Description: c 线程池功能测试
+             覆盖 destroy 时由 pending 回调释放未执行的侵入式节点
+             编译运行：g++ -O1 threadpool_test.cc threadpool.cc -o threadpool_test -pthread && ./threadpool_test
+Version history
+
+[序号]    |   [修改日期]  |   [修改者]   |   [修改内容]
+1            2026-10-18       cjx         create
+
+*****************************************************************/
+
+#include "threadpool.h"
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+static int g_failures = 0;
+
+#define CHECK(cond)                                                             \
+	do                                                                          \
+	{                                                                           \
+		if (!(cond))                                                            \
+		{                                                                       \
+			printf("  FAILED %s:%d: %s\n", __FILE__, __LINE__, #cond);          \
+			g_failures++;                                                       \
+		}                                                                       \
+	} while (0)
+
+// 调用方的任务结构体，内嵌线程池节点
+struct user_task
+{
+	int id;
+	struct threadpool_task_node node;
+};
+
+static int g_ran = 0;
+static int g_freed = 0;
+static volatile int g_blocker_started = 0;
+
+static void user_routine(void *data)
+{
+	__atomic_fetch_add(&g_ran, 1, __ATOMIC_RELAXED);
+	free(data);
+}
+
+static void blocker_routine(void *data)
+{
+	(void)data;
+	__atomic_store_n(&g_blocker_started, 1, __ATOMIC_RELEASE);
+	usleep(50 * 1000);
+}
+
+// 未执行的侵入式节点由 pending 回调连同外层结构体一起释放
+static void free_pending(const struct threadpool_task *task)
+{
+	struct user_task *ut = (struct user_task *)task->data;
+	g_freed++;
+	free(ut);
+}
+
+static void test_destroy_pending_intrusive(void)
+{
+	struct threadpool_task blocker = {blocker_routine, NULL};
+	threadpool_t *pool;
+	int i;
+
+	printf("destroy frees pending intrusive nodes\n");
+	pool = threadpool_create(1, 0);
+	CHECK(pool != NULL);
+
+	// 唯一的工作线程执行 blocker 时排入侵入式节点，destroy 后它们不再执行
+	CHECK(threadpool_schedule(&blocker, pool) == 0);
+	while (!__atomic_load_n(&g_blocker_started, __ATOMIC_ACQUIRE))
+		usleep(1000);
+
+	for (i = 0; i < 8; i++)
+	{
+		struct user_task *ut = (struct user_task *)malloc(sizeof (struct user_task));
+		ut->id = i;
+		ut->node.task.routine = user_routine;
+		ut->node.task.data = ut;
+		threadpool_schedule_intrusive(&ut->node, pool);
+	}
+
+	threadpool_destroy(free_pending, pool);
+	CHECK(g_ran + g_freed == 8);
+	CHECK(g_freed > 0);
+}
+
+int main(void)
+{
+	test_destroy_pending_intrusive();
+
+	if (g_failures > 0)
+	{
+		printf("%d check(s) failed\n", g_failures);
+		return 1;
+	}
+	printf("all passed\n");
+	return 0;
+}